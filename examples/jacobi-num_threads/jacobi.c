@@ -328,7 +328,7 @@ double jacobi_omp(int n, int m, REAL dx, REAL dy, REAL alpha, REAL omega, REAL *
     rtune_var_set_update_schedule_attr(num_threads, RTUNE_UPDATE_REGION_BEGIN, RTUNE_UPDATE_LIST_SERIES, 0, 20, 0);
  //   rtune_var_set_update_schedule_attr(num_threads2, RTUNE_UPDATE_REGION_BEGIN, RTUNE_UPDATE_LIST_SERIES, 70, 5, 6);
  //   rtune_func_t * exe_time = rtune_func_add_model(jacobi_region, RTUNE_FUNC_EXT_DIFF, "exe_time", RTUNE_double, read_timer_ms, NULL, 2, num_threads, num_threads2);
-    rtune_func_t * exe_time = rtune_func_add_model(jacobi_region, RTUNE_FUNC_EXT_DIFF, "exe_time", RTUNE_double, read_timer_ms, NULL, 1, num_threads);
+    rtune_func_t * exe_time = rtune_func_add_model(jacobi_region, RTUNE_FUNC_EXT_DIFF, "exe_time", RTUNE_double, RTUNE_TIMER_MS, NULL, 1, num_threads);
     rtune_func_set_update_schedule_attr(exe_time, RTUNE_UPDATE_REGION_BEGIN_END_DIFF, RTUNE_UPDATE_BATCH_ACCUMULATE, RTUNE_DEFAULT_NONE, RTUNE_DEFAULT_NONE, RTUNE_DEFAULT_NONE );
     rtune_objective_t * min_exe_time = rtune_objective_add_min(jacobi_region, "min exe time", exe_time);
     //rtune_objective_set_search_strategy(min_exe_time, RTUNE_OBJECTIVE_SEARCH_UNIMODAL_ON_THE_FLY);
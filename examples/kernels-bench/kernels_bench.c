@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <rtune_runtime.h>
+
+/**
+ * Microbenchmark of the scan kernels of RTune: argmin/argmax and the trend over a long trace of states of each data type,
+ * with the portable loop and with each SIMD ISA the CPU supports. The indices and counts of each ISA are checked
+ * against the portable loop.
+ *
+ * Usage: kernels-bench [num_states] [repeats]
+ */
+#define NUM_TYPES 5
+
+static const char *type_names[NUM_TYPES] = {"short", "int", "long", "float", "double"};
+static const size_t type_sizes[NUM_TYPES] = {sizeof(short), sizeof(int), sizeof(long), sizeof(float), sizeof(double)};
+static const char *isa_names[] = {"scalar", "avx2", "avx512"};
+
+/**
+ * a noisy trace around a slow trend, as the states of a func sampled over many iterations
+ */
+static void fill_states(rtune_data_type_t type, void *states, int num_states) {
+    int i;
+    for (i = 0; i < num_states; i++) {
+        double x = 1000.0 + (i % 4096) * 0.5 + (rand() % 1000);
+        switch (type) {
+            case RTUNE_short: ((short *) states)[i] = (short) (x / 2); break;
+            case RTUNE_int: ((int *) states)[i] = (int) x; break;
+            case RTUNE_long: ((long *) states)[i] = (long) x; break;
+            case RTUNE_float: ((float *) states)[i] = (float) x; break;
+            case RTUNE_double: ((double *) states)[i] = x; break;
+            default: break;
+        }
+    }
+}
+
+typedef struct result {
+    int argmin;
+    int argmax;
+    int trend;
+    double argmin_ms;
+    double argmax_ms;
+    double trend_ms;
+} result_t;
+
+static result_t run(rtune_data_type_t type, void *states, double *dispersion, int num_states, int repeats) {
+    result_t r;
+    int k;
+    double t0 = rtune_timer_ms(NULL);
+    for (k = 0; k < repeats; k++) r.argmin = rtune_kernel_argmin(type, states, num_states);
+    double t1 = rtune_timer_ms(NULL);
+    for (k = 0; k < repeats; k++) r.argmax = rtune_kernel_argmax(type, states, num_states);
+    double t2 = rtune_timer_ms(NULL);
+    for (k = 0; k < repeats; k++) r.trend = rtune_kernel_trend(type, states, dispersion, num_states, 0.05, 1);
+    double t3 = rtune_timer_ms(NULL);
+    r.argmin_ms = (t1 - t0) / repeats;
+    r.argmax_ms = (t2 - t1) / repeats;
+    r.trend_ms = (t3 - t2) / repeats;
+    return r;
+}
+
+int main(int argc, char *argv[]) {
+    int num_states = argc > 1 ? atoi(argv[1]) : 1 << 20;
+    int repeats = argc > 2 ? atoi(argv[2]) : 50;
+    rtune_kernel_isa_t widest = rtune_kernel_get_isa();
+    int errors = 0;
+    int t, i;
+
+    double *dispersion = (double *) malloc(sizeof(double) * num_states);
+    for (i = 0; i < num_states; i++) dispersion[i] = (rand() % 100) * 0.1;
+
+    printf("%d states, %d repeats, widest ISA: %s\n", num_states, repeats, isa_names[widest]);
+    printf("%-7s %-7s %12s %8s %12s %8s %12s %8s\n", "type", "isa", "argmin(ms)", "speedup", "argmax(ms)", "speedup", "trend(ms)", "speedup");
+    for (t = 0; t < NUM_TYPES; t++) {
+        rtune_data_type_t type = (rtune_data_type_t) t;
+        void *states = malloc(type_sizes[t] * num_states);
+        fill_states(type, states, num_states);
+
+        result_t base;
+        int isa;
+        for (isa = RTUNE_KERNEL_SCALAR; isa <= widest; isa++) {
+            rtune_kernel_set_isa((rtune_kernel_isa_t) isa);
+            result_t r = run(type, states, dispersion, num_states, repeats);
+            if (isa == RTUNE_KERNEL_SCALAR) base = r;
+            printf("%-7s %-7s %12.4f %7.2fx %12.4f %7.2fx %12.4f %7.2fx\n", type_names[t], isa_names[isa],
+                   r.argmin_ms, base.argmin_ms / r.argmin_ms, r.argmax_ms, base.argmax_ms / r.argmax_ms, r.trend_ms, base.trend_ms / r.trend_ms);
+            if (r.argmin != base.argmin || r.argmax != base.argmax || r.trend != base.trend) {
+                printf("  mismatch with scalar: argmin %d/%d, argmax %d/%d, trend %d/%d\n",
+                       r.argmin, base.argmin, r.argmax, base.argmax, r.trend, base.trend);
+                errors++;
+            }
+        }
+        rtune_kernel_set_isa(widest);
+        free(states);
+    }
+    free(dispersion);
+    return errors != 0;
+}
@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <rtune_runtime.h>
+
+/**
+ * The energy provider and the cpufreq applier of RTune on a fake sysfs tree in a temp dir (see rtune_sysfs_set_root), so
+ * they can be checked without RAPL or the permission to set the CPU frequency: the energy_uj counter of a RAPL zone wraps
+ * around max_energy_range_uj, and the CPUs have the userspace governor with a writable scaling_setspeed, which is written
+ * back to its value when rtune is done with it.
+ *
+ * Usage: sysfs-providers
+ */
+#define MAX_RANGE_UJ 1000000ULL
+#define SAVED_KHZ 2400000L
+
+static char root[] = "/tmp/rtune-sysfs-XXXXXX";
+
+static void mkdirs(const char *path) {
+    char dir[1024];
+    char *p;
+    snprintf(dir, sizeof(dir), "%s", path);
+    for (p = dir + strlen(root) + 1; *p != '\0'; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        mkdir(dir, 0755);
+        *p = '/';
+    }
+    mkdir(dir, 0755);
+}
+
+static void write_file(const char *file, const char *value) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", root, file);
+    FILE *f = fopen(path, "w");
+    if (f == NULL) return;
+    fputs(value, f);
+    fclose(f);
+}
+
+static long read_file(const char *file) {
+    char path[1024];
+    long value = -1;
+    snprintf(path, sizeof(path), "%s/%s", root, file);
+    FILE *f = fopen(path, "r");
+    if (f == NULL) return -1;
+    if (fscanf(f, "%ld", &value) != 1) value = -1;
+    fclose(f);
+    return value;
+}
+
+static void set_energy_uj(unsigned long long uj) {
+    char value[32];
+    snprintf(value, sizeof(value), "%llu\n", uj);
+    write_file("class/powercap/intel-rapl:0/energy_uj", value);
+}
+
+static int check(const char *what, double value, double expected) {
+    int ok = fabs(value - expected) < 1e-9;
+    printf("%-40s %12g %12g %s\n", what, value, expected, ok ? "ok" : "FAIL");
+    return !ok;
+}
+
+int main(void) {
+    char path[1024];
+    char value[32];
+    int errors = 0;
+    int cpu;
+    if (mkdtemp(root) == NULL) {
+        perror("mkdtemp");
+        return 1;
+    }
+    snprintf(path, sizeof(path), "%s/class/powercap/intel-rapl:0", root);
+    mkdirs(path);
+    snprintf(value, sizeof(value), "%llu\n", MAX_RANGE_UJ);
+    write_file("class/powercap/intel-rapl:0/max_energy_range_uj", value);
+    set_energy_uj(MAX_RANGE_UJ - 300000);
+
+    long num_cpus = sysconf(_SC_NPROCESSORS_CONF);
+    if (num_cpus < 1) num_cpus = 1;
+    for (cpu = 0; cpu < num_cpus; cpu++) {
+        char file[128];
+        snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%d/cpufreq", root, cpu);
+        mkdirs(path);
+        snprintf(file, sizeof(file), "devices/system/cpu/cpu%d/cpufreq/scaling_governor", cpu);
+        write_file(file, "userspace\n");
+        snprintf(file, sizeof(file), "devices/system/cpu/cpu%d/cpufreq/scaling_setspeed", cpu);
+        snprintf(value, sizeof(value), "%ld\n", SAVED_KHZ);
+        write_file(file, value);
+    }
+    rtune_sysfs_set_root(root);
+
+    printf("%-40s %12s %12s\n", "check", "value", "expected");
+    rtune_region_t *region = rtune_region_init("sysfs");
+    rtune_energy_t *energy = rtune_energy_add(region);
+    if (energy == NULL) {
+        printf("the fake RAPL zone cannot be read\n");
+        return 1;
+    }
+    errors += check("energy (J) when the zone is opened", rtune_energy_read(energy), 0.0);
+    rtune_region_begin(region); //a new epoch of the region, in which the zone is read again
+    set_energy_uj(MAX_RANGE_UJ - 100000);
+    errors += check("energy (J) after 0.2 J", rtune_energy_read(energy), 0.2);
+    rtune_region_end(region);
+    set_energy_uj(399999); //0.1 J to the wraparound, 1 uj for it, and then 0.399999 J
+    errors += check("energy (J) after 0.5 J with a wraparound", rtune_energy_read(energy), 0.7);
+
+    errors += check("CPUs whose frequency can be set", rtune_cpufreq_init(), num_cpus);
+    rtune_cpufreq_apply((void *) 1200000L);
+    errors += check("scaling_setspeed (kHz) of cpu0", read_file("devices/system/cpu/cpu0/cpufreq/scaling_setspeed"), 1200000);
+    rtune_cpufreq_fini();
+    errors += check("scaling_setspeed (kHz) of cpu0 restored", read_file("devices/system/cpu/cpu0/cpufreq/scaling_setspeed"), SAVED_KHZ);
+    rtune_region_fini(region);
+
+    snprintf(path, sizeof(path), "rm -rf %s", root);
+    if (system(path) != 0) printf("%s cannot be removed\n", root);
+    return errors != 0;
+}
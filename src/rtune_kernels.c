@@ -0,0 +1,406 @@
+#include <pthread.h>
+#include <math.h>
+
+#include "rtune_runtime.h"
+
+/**
+ * Scan kernels over an array of states: the argmin/argmax used by the find min/max of a stvar, and the trend of consecutive
+ * states used by the unimodal checks. Each is defined for the five numeric types with a portable loop and, on x86-64,
+ * AVX2 and AVX-512 versions that are compiled with the target attribute, so the library does not need to be built for
+ * a specific CPU. The version is selected once by the CPU features, see rtune_kernel_get_isa.
+ *
+ * argmin/argmax return the LAST index of the min/max, as the exhaustive scan with <= and >= does. The SIMD versions find
+ * the min/max with a lane-wise reduction first and then scan backward for the last element that is equal to it, so
+ * there is no data-dependent branch in the reduction. NaN states are not ordered.
+ */
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define RTUNE_HAVE_SIMD_KERNELS 1
+#endif
+
+typedef int (*rtune_kernel_arg_t) (const void *values, int count);
+typedef int (*rtune_kernel_trend_t) (const void *values, const double *dispersion, int count, double tolerance, int increasing);
+
+/**
+ * the kernels of an ISA, indexed by rtune_data_type_t
+ */
+typedef struct rtune_kernels {
+    rtune_kernel_isa_t isa;
+    rtune_kernel_arg_t argmin[RTUNE_void];
+    rtune_kernel_arg_t argmax[RTUNE_void];
+    rtune_kernel_trend_t trend[RTUNE_void];
+} rtune_kernels_t;
+
+#define RTUNE_KERNEL_BETTER_min(a, b) ((a) < (b))
+#define RTUNE_KERNEL_BETTER_max(a, b) ((a) > (b))
+
+/**
+ * whether the pair of states (f0, f1) is a step of the trend: the relative deviation is at least the tolerance in the
+ * direction, and the deviation is not within the dispersion (d0, d1) of the batches the states are reduced from
+ */
+#define RTUNE_KERNEL_TREND_STEP(f0, f1, d0, d1, dispersion, tolerance, increasing) \
+    (fabs((f1) - (f0)) / (f0) >= (tolerance) && ((increasing) ? (f1) - (f0) >= 0 : (f1) - (f0) <= 0) \
+     && !((dispersion) != NULL && fabs((f1) - (f0)) < sqrt((d0) * (d0) + (d1) * (d1))))
+
+#define RTUNE_KERNEL_SCALAR_DEFINE(TYPE) \
+    static int rtune_kernel_argmin_scalar_##TYPE(const void *values, int count) { \
+        const TYPE *v = (const TYPE *) values; \
+        TYPE m = v[0]; \
+        int index = 0; \
+        int i; \
+        for (i = 1; i < count; i++) { \
+            if (v[i] <= m) { \
+                m = v[i]; \
+                index = i; \
+            } \
+        } \
+        return index; \
+    } \
+    static int rtune_kernel_argmax_scalar_##TYPE(const void *values, int count) { \
+        const TYPE *v = (const TYPE *) values; \
+        TYPE m = v[0]; \
+        int index = 0; \
+        int i; \
+        for (i = 1; i < count; i++) { \
+            if (v[i] >= m) { \
+                m = v[i]; \
+                index = i; \
+            } \
+        } \
+        return index; \
+    } \
+    static int rtune_kernel_trend_scalar_##TYPE(const void *values, const double *dispersion, int count, double tolerance, int increasing) { \
+        const TYPE *v = (const TYPE *) values; \
+        int trend = 0; \
+        int i; \
+        for (i = 1; i < count; i++) { \
+            double f0 = (double) v[i-1]; \
+            double f1 = (double) v[i]; \
+            double d0 = dispersion != NULL ? dispersion[i-1] : 0.0; \
+            double d1 = dispersion != NULL ? dispersion[i] : 0.0; \
+            if (RTUNE_KERNEL_TREND_STEP(f0, f1, d0, d1, dispersion, tolerance, increasing)) trend++; \
+        } \
+        return trend; \
+    }
+
+RTUNE_KERNEL_SCALAR_DEFINE(short)
+RTUNE_KERNEL_SCALAR_DEFINE(int)
+RTUNE_KERNEL_SCALAR_DEFINE(long)
+RTUNE_KERNEL_SCALAR_DEFINE(float)
+RTUNE_KERNEL_SCALAR_DEFINE(double)
+
+static const rtune_kernels_t rtune_kernels_scalar = {
+    RTUNE_KERNEL_SCALAR,
+    {rtune_kernel_argmin_scalar_short, rtune_kernel_argmin_scalar_int, rtune_kernel_argmin_scalar_long,
+     rtune_kernel_argmin_scalar_float, rtune_kernel_argmin_scalar_double},
+    {rtune_kernel_argmax_scalar_short, rtune_kernel_argmax_scalar_int, rtune_kernel_argmax_scalar_long,
+     rtune_kernel_argmax_scalar_float, rtune_kernel_argmax_scalar_double},
+    {rtune_kernel_trend_scalar_short, rtune_kernel_trend_scalar_int, rtune_kernel_trend_scalar_long,
+     rtune_kernel_trend_scalar_float, rtune_kernel_trend_scalar_double},
+};
+
+#ifdef RTUNE_HAVE_SIMD_KERNELS
+
+#define RTUNE_TARGET_AVX2 __attribute__((target("avx2")))
+#define RTUNE_TARGET_AVX512 __attribute__((target("avx2,avx512f,avx512bw,avx512dq")))
+
+/**
+ * The vector ops of each type for an ISA, named RTUNE_<ISA>_<TYPE>_<OP>. EQ returns a bitmask of the lanes that are
+ * equal, with LANE_BITS bits per lane. TO_PD loads LANES_PD states converted to double for the trend.
+ */
+RTUNE_TARGET_AVX2 static inline __m256i rtune_mm256_min_epi64(__m256i a, __m256i b) {
+    return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+}
+
+RTUNE_TARGET_AVX2 static inline __m256i rtune_mm256_max_epi64(__m256i a, __m256i b) {
+    return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(b, a));
+}
+
+#define RTUNE_AVX2_LANES_PD 4
+#define RTUNE_AVX2_short_VEC __m256i
+#define RTUNE_AVX2_short_LANES 16
+#define RTUNE_AVX2_short_LANE_BITS 2
+#define RTUNE_AVX2_short_LOAD(p) _mm256_loadu_si256((const __m256i *) (p))
+#define RTUNE_AVX2_short_STORE(p, a) _mm256_storeu_si256((__m256i *) (p), a)
+#define RTUNE_AVX2_short_SET1(x) _mm256_set1_epi16(x)
+#define RTUNE_AVX2_short_min(a, b) _mm256_min_epi16(a, b)
+#define RTUNE_AVX2_short_max(a, b) _mm256_max_epi16(a, b)
+#define RTUNE_AVX2_short_EQ(a, b) (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi16(a, b))
+#define RTUNE_AVX2_short_TO_PD(p) _mm256_cvtepi32_pd(_mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *) (p))))
+
+#define RTUNE_AVX2_int_VEC __m256i
+#define RTUNE_AVX2_int_LANES 8
+#define RTUNE_AVX2_int_LANE_BITS 1
+#define RTUNE_AVX2_int_LOAD(p) _mm256_loadu_si256((const __m256i *) (p))
+#define RTUNE_AVX2_int_STORE(p, a) _mm256_storeu_si256((__m256i *) (p), a)
+#define RTUNE_AVX2_int_SET1(x) _mm256_set1_epi32(x)
+#define RTUNE_AVX2_int_min(a, b) _mm256_min_epi32(a, b)
+#define RTUNE_AVX2_int_max(a, b) _mm256_max_epi32(a, b)
+#define RTUNE_AVX2_int_EQ(a, b) (unsigned int) _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)))
+#define RTUNE_AVX2_int_TO_PD(p) _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i *) (p)))
+
+#define RTUNE_AVX2_long_VEC __m256i
+#define RTUNE_AVX2_long_LANES 4
+#define RTUNE_AVX2_long_LANE_BITS 1
+#define RTUNE_AVX2_long_LOAD(p) _mm256_loadu_si256((const __m256i *) (p))
+#define RTUNE_AVX2_long_STORE(p, a) _mm256_storeu_si256((__m256i *) (p), a)
+#define RTUNE_AVX2_long_SET1(x) _mm256_set1_epi64x(x)
+#define RTUNE_AVX2_long_min(a, b) rtune_mm256_min_epi64(a, b)
+#define RTUNE_AVX2_long_max(a, b) rtune_mm256_max_epi64(a, b)
+#define RTUNE_AVX2_long_EQ(a, b) (unsigned int) _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b)))
+#define RTUNE_AVX2_long_TO_PD(p) _mm256_set_pd((double) (p)[3], (double) (p)[2], (double) (p)[1], (double) (p)[0]) //no cvtepi64_pd before AVX-512DQ
+
+#define RTUNE_AVX2_float_VEC __m256
+#define RTUNE_AVX2_float_LANES 8
+#define RTUNE_AVX2_float_LANE_BITS 1
+#define RTUNE_AVX2_float_LOAD(p) _mm256_loadu_ps(p)
+#define RTUNE_AVX2_float_STORE(p, a) _mm256_storeu_ps(p, a)
+#define RTUNE_AVX2_float_SET1(x) _mm256_set1_ps(x)
+#define RTUNE_AVX2_float_min(a, b) _mm256_min_ps(a, b)
+#define RTUNE_AVX2_float_max(a, b) _mm256_max_ps(a, b)
+#define RTUNE_AVX2_float_EQ(a, b) (unsigned int) _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ))
+#define RTUNE_AVX2_float_TO_PD(p) _mm256_cvtps_pd(_mm_loadu_ps(p))
+
+#define RTUNE_AVX2_double_VEC __m256d
+#define RTUNE_AVX2_double_LANES 4
+#define RTUNE_AVX2_double_LANE_BITS 1
+#define RTUNE_AVX2_double_LOAD(p) _mm256_loadu_pd(p)
+#define RTUNE_AVX2_double_STORE(p, a) _mm256_storeu_pd(p, a)
+#define RTUNE_AVX2_double_SET1(x) _mm256_set1_pd(x)
+#define RTUNE_AVX2_double_min(a, b) _mm256_min_pd(a, b)
+#define RTUNE_AVX2_double_max(a, b) _mm256_max_pd(a, b)
+#define RTUNE_AVX2_double_EQ(a, b) (unsigned int) _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ))
+#define RTUNE_AVX2_double_TO_PD(p) _mm256_loadu_pd(p)
+
+#define RTUNE_AVX512_LANES_PD 8
+#define RTUNE_AVX512_short_VEC __m512i
+#define RTUNE_AVX512_short_LANES 32
+#define RTUNE_AVX512_short_LANE_BITS 1
+#define RTUNE_AVX512_short_LOAD(p) _mm512_loadu_si512((const void *) (p))
+#define RTUNE_AVX512_short_STORE(p, a) _mm512_storeu_si512((void *) (p), a)
+#define RTUNE_AVX512_short_SET1(x) _mm512_set1_epi16(x)
+#define RTUNE_AVX512_short_min(a, b) _mm512_min_epi16(a, b)
+#define RTUNE_AVX512_short_max(a, b) _mm512_max_epi16(a, b)
+#define RTUNE_AVX512_short_EQ(a, b) (unsigned int) _mm512_cmpeq_epi16_mask(a, b)
+#define RTUNE_AVX512_short_TO_PD(p) _mm512_cvtepi32_pd(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) (p))))
+
+#define RTUNE_AVX512_int_VEC __m512i
+#define RTUNE_AVX512_int_LANES 16
+#define RTUNE_AVX512_int_LANE_BITS 1
+#define RTUNE_AVX512_int_LOAD(p) _mm512_loadu_si512((const void *) (p))
+#define RTUNE_AVX512_int_STORE(p, a) _mm512_storeu_si512((void *) (p), a)
+#define RTUNE_AVX512_int_SET1(x) _mm512_set1_epi32(x)
+#define RTUNE_AVX512_int_min(a, b) _mm512_min_epi32(a, b)
+#define RTUNE_AVX512_int_max(a, b) _mm512_max_epi32(a, b)
+#define RTUNE_AVX512_int_EQ(a, b) (unsigned int) _mm512_cmpeq_epi32_mask(a, b)
+#define RTUNE_AVX512_int_TO_PD(p) _mm512_cvtepi32_pd(_mm256_loadu_si256((const __m256i *) (p)))
+
+#define RTUNE_AVX512_long_VEC __m512i
+#define RTUNE_AVX512_long_LANES 8
+#define RTUNE_AVX512_long_LANE_BITS 1
+#define RTUNE_AVX512_long_LOAD(p) _mm512_loadu_si512((const void *) (p))
+#define RTUNE_AVX512_long_STORE(p, a) _mm512_storeu_si512((void *) (p), a)
+#define RTUNE_AVX512_long_SET1(x) _mm512_set1_epi64(x)
+#define RTUNE_AVX512_long_min(a, b) _mm512_min_epi64(a, b)
+#define RTUNE_AVX512_long_max(a, b) _mm512_max_epi64(a, b)
+#define RTUNE_AVX512_long_EQ(a, b) (unsigned int) _mm512_cmpeq_epi64_mask(a, b)
+#define RTUNE_AVX512_long_TO_PD(p) _mm512_cvtepi64_pd(_mm512_loadu_si512((const void *) (p)))
+
+#define RTUNE_AVX512_float_VEC __m512
+#define RTUNE_AVX512_float_LANES 16
+#define RTUNE_AVX512_float_LANE_BITS 1
+#define RTUNE_AVX512_float_LOAD(p) _mm512_loadu_ps(p)
+#define RTUNE_AVX512_float_STORE(p, a) _mm512_storeu_ps(p, a)
+#define RTUNE_AVX512_float_SET1(x) _mm512_set1_ps(x)
+#define RTUNE_AVX512_float_min(a, b) _mm512_min_ps(a, b)
+#define RTUNE_AVX512_float_max(a, b) _mm512_max_ps(a, b)
+#define RTUNE_AVX512_float_EQ(a, b) (unsigned int) _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ)
+#define RTUNE_AVX512_float_TO_PD(p) _mm512_cvtps_pd(_mm256_loadu_ps(p))
+
+#define RTUNE_AVX512_double_VEC __m512d
+#define RTUNE_AVX512_double_LANES 8
+#define RTUNE_AVX512_double_LANE_BITS 1
+#define RTUNE_AVX512_double_LOAD(p) _mm512_loadu_pd(p)
+#define RTUNE_AVX512_double_STORE(p, a) _mm512_storeu_pd(p, a)
+#define RTUNE_AVX512_double_SET1(x) _mm512_set1_pd(x)
+#define RTUNE_AVX512_double_min(a, b) _mm512_min_pd(a, b)
+#define RTUNE_AVX512_double_max(a, b) _mm512_max_pd(a, b)
+#define RTUNE_AVX512_double_EQ(a, b) (unsigned int) _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ)
+#define RTUNE_AVX512_double_TO_PD(p) _mm512_loadu_pd(p)
+
+/**
+ * the argmin (OP is min) or argmax (OP is max) of a type for an ISA. The states that do not fill a vector are handled by
+ * scalar code in both passes. If no element is equal to the reduced min/max, which can only happen with NaN states,
+ * it falls back to the scalar scan.
+ */
+#define RTUNE_KERNEL_ARG_SIMD_DEFINE(ISA, isa, TYPE, OP) \
+    RTUNE_TARGET_##ISA static int rtune_kernel_arg##OP##_##isa##_##TYPE(const void *values, int count) { \
+        const TYPE *v = (const TYPE *) values; \
+        int lanes = RTUNE_##ISA##_##TYPE##_LANES; \
+        int num_vectors = count / lanes; \
+        int n = num_vectors * lanes; \
+        int i; \
+        if (num_vectors < 2) return rtune_kernel_arg##OP##_scalar_##TYPE(values, count); \
+        RTUNE_##ISA##_##TYPE##_VEC acc = RTUNE_##ISA##_##TYPE##_LOAD(v); \
+        for (i = lanes; i < n; i += lanes) acc = RTUNE_##ISA##_##TYPE##_##OP(acc, RTUNE_##ISA##_##TYPE##_LOAD(v + i)); \
+        TYPE lane_values[RTUNE_##ISA##_##TYPE##_LANES]; \
+        RTUNE_##ISA##_##TYPE##_STORE(lane_values, acc); \
+        TYPE m = lane_values[0]; \
+        for (i = 1; i < lanes; i++) if (RTUNE_KERNEL_BETTER_##OP(lane_values[i], m)) m = lane_values[i]; \
+        for (i = n; i < count; i++) if (RTUNE_KERNEL_BETTER_##OP(v[i], m)) m = v[i]; \
+        for (i = count - 1; i >= n; i--) if (v[i] == m) return i; \
+        RTUNE_##ISA##_##TYPE##_VEC target = RTUNE_##ISA##_##TYPE##_SET1(m); \
+        for (i = n - lanes; i >= 0; i -= lanes) { \
+            unsigned int mask = RTUNE_##ISA##_##TYPE##_EQ(RTUNE_##ISA##_##TYPE##_LOAD(v + i), target); \
+            if (mask != 0) return i + (31 - __builtin_clz(mask)) / RTUNE_##ISA##_##TYPE##_LANE_BITS; \
+        } \
+        return rtune_kernel_arg##OP##_scalar_##TYPE(values, count); \
+    }
+
+/**
+ * the trend of a type for an ISA. Each vector is the deviations of LANES_PD consecutive pairs (v[i-1], v[i]) computed in
+ * double, as RTUNE_KERNEL_TREND_STEP for each pair, and the steps are counted from the mask of the pairs.
+ */
+#define RTUNE_KERNEL_TREND_AVX2_DEFINE(TYPE) \
+    RTUNE_TARGET_AVX2 static int rtune_kernel_trend_avx2_##TYPE(const void *values, const double *dispersion, int count, double tolerance, int increasing) { \
+        const TYPE *v = (const TYPE *) values; \
+        __m256d tol = _mm256_set1_pd(tolerance); \
+        __m256d zero = _mm256_setzero_pd(); \
+        __m256d sign = _mm256_set1_pd(-0.0); \
+        int trend = 0; \
+        int i; \
+        for (i = 1; i + RTUNE_AVX2_LANES_PD <= count; i += RTUNE_AVX2_LANES_PD) { \
+            __m256d f0 = RTUNE_AVX2_##TYPE##_TO_PD(v + i - 1); \
+            __m256d f1 = RTUNE_AVX2_##TYPE##_TO_PD(v + i); \
+            __m256d deviation = _mm256_sub_pd(f1, f0); \
+            __m256d abs_deviation = _mm256_andnot_pd(sign, deviation); \
+            __m256d step = _mm256_cmp_pd(_mm256_div_pd(abs_deviation, f0), tol, _CMP_GE_OQ); \
+            step = _mm256_and_pd(step, increasing ? _mm256_cmp_pd(deviation, zero, _CMP_GE_OQ) \
+                                                  : _mm256_cmp_pd(deviation, zero, _CMP_LE_OQ)); \
+            if (dispersion != NULL) { \
+                __m256d d0 = _mm256_loadu_pd(dispersion + i - 1); \
+                __m256d d1 = _mm256_loadu_pd(dispersion + i); \
+                __m256d noise = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(d0, d0), _mm256_mul_pd(d1, d1))); \
+                step = _mm256_andnot_pd(_mm256_cmp_pd(abs_deviation, noise, _CMP_LT_OQ), step); \
+            } \
+            trend += __builtin_popcount(_mm256_movemask_pd(step)); \
+        } \
+        return trend + rtune_kernel_trend_scalar_##TYPE(v + i - 1, dispersion != NULL ? dispersion + i - 1 : NULL, count - i + 1, tolerance, increasing); \
+    }
+
+#define RTUNE_KERNEL_TREND_AVX512_DEFINE(TYPE) \
+    RTUNE_TARGET_AVX512 static int rtune_kernel_trend_avx512_##TYPE(const void *values, const double *dispersion, int count, double tolerance, int increasing) { \
+        const TYPE *v = (const TYPE *) values; \
+        __m512d tol = _mm512_set1_pd(tolerance); \
+        __m512d zero = _mm512_setzero_pd(); \
+        int trend = 0; \
+        int i; \
+        for (i = 1; i + RTUNE_AVX512_LANES_PD <= count; i += RTUNE_AVX512_LANES_PD) { \
+            __m512d f0 = RTUNE_AVX512_##TYPE##_TO_PD(v + i - 1); \
+            __m512d f1 = RTUNE_AVX512_##TYPE##_TO_PD(v + i); \
+            __m512d deviation = _mm512_sub_pd(f1, f0); \
+            __m512d abs_deviation = _mm512_abs_pd(deviation); \
+            __mmask8 step = _mm512_cmp_pd_mask(_mm512_div_pd(abs_deviation, f0), tol, _CMP_GE_OQ); \
+            step &= increasing ? _mm512_cmp_pd_mask(deviation, zero, _CMP_GE_OQ) : _mm512_cmp_pd_mask(deviation, zero, _CMP_LE_OQ); \
+            if (dispersion != NULL) { \
+                __m512d d0 = _mm512_loadu_pd(dispersion + i - 1); \
+                __m512d d1 = _mm512_loadu_pd(dispersion + i); \
+                __m512d noise = _mm512_sqrt_pd(_mm512_add_pd(_mm512_mul_pd(d0, d0), _mm512_mul_pd(d1, d1))); \
+                step &= ~_mm512_cmp_pd_mask(abs_deviation, noise, _CMP_LT_OQ); \
+            } \
+            trend += __builtin_popcount(step); \
+        } \
+        return trend + rtune_kernel_trend_scalar_##TYPE(v + i - 1, dispersion != NULL ? dispersion + i - 1 : NULL, count - i + 1, tolerance, increasing); \
+    }
+
+#define RTUNE_KERNEL_SIMD_DEFINE(TYPE) \
+    RTUNE_KERNEL_ARG_SIMD_DEFINE(AVX2, avx2, TYPE, min) \
+    RTUNE_KERNEL_ARG_SIMD_DEFINE(AVX2, avx2, TYPE, max) \
+    RTUNE_KERNEL_ARG_SIMD_DEFINE(AVX512, avx512, TYPE, min) \
+    RTUNE_KERNEL_ARG_SIMD_DEFINE(AVX512, avx512, TYPE, max) \
+    RTUNE_KERNEL_TREND_AVX2_DEFINE(TYPE) \
+    RTUNE_KERNEL_TREND_AVX512_DEFINE(TYPE)
+
+RTUNE_KERNEL_SIMD_DEFINE(short)
+RTUNE_KERNEL_SIMD_DEFINE(int)
+RTUNE_KERNEL_SIMD_DEFINE(long)
+RTUNE_KERNEL_SIMD_DEFINE(float)
+RTUNE_KERNEL_SIMD_DEFINE(double)
+
+static const rtune_kernels_t rtune_kernels_avx2 = {
+    RTUNE_KERNEL_AVX2,
+    {rtune_kernel_argmin_avx2_short, rtune_kernel_argmin_avx2_int, rtune_kernel_argmin_avx2_long,
+     rtune_kernel_argmin_avx2_float, rtune_kernel_argmin_avx2_double},
+    {rtune_kernel_argmax_avx2_short, rtune_kernel_argmax_avx2_int, rtune_kernel_argmax_avx2_long,
+     rtune_kernel_argmax_avx2_float, rtune_kernel_argmax_avx2_double},
+    {rtune_kernel_trend_avx2_short, rtune_kernel_trend_avx2_int, rtune_kernel_trend_avx2_long,
+     rtune_kernel_trend_avx2_float, rtune_kernel_trend_avx2_double},
+};
+
+static const rtune_kernels_t rtune_kernels_avx512 = {
+    RTUNE_KERNEL_AVX512,
+    {rtune_kernel_argmin_avx512_short, rtune_kernel_argmin_avx512_int, rtune_kernel_argmin_avx512_long,
+     rtune_kernel_argmin_avx512_float, rtune_kernel_argmin_avx512_double},
+    {rtune_kernel_argmax_avx512_short, rtune_kernel_argmax_avx512_int, rtune_kernel_argmax_avx512_long,
+     rtune_kernel_argmax_avx512_float, rtune_kernel_argmax_avx512_double},
+    {rtune_kernel_trend_avx512_short, rtune_kernel_trend_avx512_int, rtune_kernel_trend_avx512_long,
+     rtune_kernel_trend_avx512_float, rtune_kernel_trend_avx512_double},
+};
+#endif
+
+static const rtune_kernels_t *rtune_kernels = &rtune_kernels_scalar;
+static rtune_kernel_isa_t rtune_kernel_isa_supported = RTUNE_KERNEL_SCALAR;
+static pthread_once_t rtune_kernel_once = PTHREAD_ONCE_INIT;
+
+static const rtune_kernels_t *rtune_kernels_of(rtune_kernel_isa_t isa) {
+#ifdef RTUNE_HAVE_SIMD_KERNELS
+    if (isa == RTUNE_KERNEL_AVX512) return &rtune_kernels_avx512;
+    if (isa == RTUNE_KERNEL_AVX2) return &rtune_kernels_avx2;
+#endif
+    return &rtune_kernels_scalar;
+}
+
+/**
+ * select the widest ISA the CPU supports, AVX-512 needs BW for the short kernels and DQ for the long-to-double conversion
+ */
+static void rtune_kernel_dispatch(void) {
+#ifdef RTUNE_HAVE_SIMD_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq")) {
+        rtune_kernel_isa_supported = RTUNE_KERNEL_AVX512;
+    } else if (__builtin_cpu_supports("avx2")) {
+        rtune_kernel_isa_supported = RTUNE_KERNEL_AVX2;
+    }
+#endif
+    rtune_kernels = rtune_kernels_of(rtune_kernel_isa_supported);
+}
+
+rtune_kernel_isa_t rtune_kernel_get_isa(void) {
+    pthread_once(&rtune_kernel_once, rtune_kernel_dispatch);
+    return rtune_kernels->isa;
+}
+
+int rtune_kernel_set_isa(rtune_kernel_isa_t isa) {
+    pthread_once(&rtune_kernel_once, rtune_kernel_dispatch);
+    if (isa < RTUNE_KERNEL_SCALAR || isa > rtune_kernel_isa_supported) return -1;
+    rtune_kernels = rtune_kernels_of(isa);
+    return 0;
+}
+
+int rtune_kernel_argmin(rtune_data_type_t type, const void * values, int count) {
+    if (count <= 0 || type < RTUNE_short || type >= RTUNE_void) return -1;
+    pthread_once(&rtune_kernel_once, rtune_kernel_dispatch);
+    return rtune_kernels->argmin[type](values, count);
+}
+
+int rtune_kernel_argmax(rtune_data_type_t type, const void * values, int count) {
+    if (count <= 0 || type < RTUNE_short || type >= RTUNE_void) return -1;
+    pthread_once(&rtune_kernel_once, rtune_kernel_dispatch);
+    return rtune_kernels->argmax[type](values, count);
+}
+
+int rtune_kernel_trend(rtune_data_type_t type, const void * values, const double * dispersion, int count, double tolerance, int increasing) {
+    if (count <= 1 || type < RTUNE_short || type >= RTUNE_void) return 0;
+    pthread_once(&rtune_kernel_once, rtune_kernel_dispatch);
+    return rtune_kernels->trend[type](values, dispersion, count, tolerance, increasing);
+}
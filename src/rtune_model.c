@@ -0,0 +1,202 @@
+#include <math.h>
+#include <string.h>
+
+#include "rtune_runtime.h"
+
+#define RTUNE_MODEL_PIVOT_EPSILON 1e-10 //relative magnitude of a pivot below which the normal equations are singular
+
+/**
+ * the features of x of a model, see rtune_model_t
+ */
+static void rtune_model_features(const rtune_model_t * model, double x, double *features) {
+    double t = (x - model->x_shift) / model->x_scale;
+    switch (model->kind) {
+        case RTUNE_MODEL_USL:
+            features[0] = 1.0;
+            features[1] = x - 1.0;
+            features[2] = x * (x - 1.0);
+            break;
+        case RTUNE_MODEL_LINEAR:
+            features[0] = 1.0;
+            features[1] = t;
+            break;
+        case RTUNE_MODEL_QUADRATIC:
+        case RTUNE_MODEL_UNIMODAL:
+            features[0] = 1.0;
+            features[1] = t;
+            features[2] = t * t;
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * the target of the least squares from the y of a sample, which is T*N for USL
+ */
+static double rtune_model_target(const rtune_model_t * model, double x, double y) {
+    return model->kind == RTUNE_MODEL_USL ? y * x : y;
+}
+
+int rtune_model_init(rtune_model_t * model, rtune_kind_t kind) {
+    memset(model, 0, sizeof(rtune_model_t));
+    model->kind = kind;
+    model->x_scale = 1.0;
+    model->r2_threshold = DEFAULT_model_r2_threshold;
+    switch (kind) {
+        case RTUNE_MODEL_LINEAR:
+            model->num_params = 2;
+            return 0;
+        case RTUNE_MODEL_USL:
+        case RTUNE_MODEL_QUADRATIC:
+        case RTUNE_MODEL_UNIMODAL:
+            model->num_params = 3;
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+/**
+ * normalize x of the linear and quadratic models to [-1, 1] over [lo, hi]. USL keeps the thread count as x since its
+ * params are the serial time and the contention and coherency cost.
+ */
+void rtune_model_set_domain(rtune_model_t * model, double lo, double hi) {
+    if (model->kind == RTUNE_MODEL_USL) return;
+    model->x_shift = (lo + hi) / 2.0;
+    model->x_scale = hi > lo ? (hi - lo) / 2.0 : 1.0;
+}
+
+void rtune_model_clear(rtune_model_t * model) {
+    memset(model->xtx, 0, sizeof(model->xtx));
+    memset(model->xty, 0, sizeof(model->xty));
+    memset(model->params, 0, sizeof(model->params));
+    model->yty = 0.0;
+    model->sum_y = 0.0;
+    model->r2 = 0.0;
+    model->num_samples = 0;
+    model->fitted = 0;
+    model->modeled = 0;
+}
+
+/**
+ * solve the normal equations by Gaussian elimination with partial pivoting
+ * @return 0 on success, -1 if they are singular, e.g. the samples are from fewer distinct x than the number of params
+ */
+static int rtune_model_solve(rtune_model_t * model) {
+    int n = model->num_params;
+    double a[RTUNE_MODEL_MAX_PARAMS][RTUNE_MODEL_MAX_PARAMS + 1];
+    double scale = 0.0;
+    int i, j, k;
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++) a[i][j] = model->xtx[i][j];
+        a[i][n] = model->xty[i];
+        if (fabs(a[i][i]) > scale) scale = fabs(a[i][i]);
+    }
+    if (scale == 0.0) return -1;
+
+    for (k = 0; k < n; k++) {
+        int pivot = k;
+        for (i = k + 1; i < n; i++) if (fabs(a[i][k]) > fabs(a[pivot][k])) pivot = i;
+        if (fabs(a[pivot][k]) <= RTUNE_MODEL_PIVOT_EPSILON * scale) return -1;
+        if (pivot != k) {
+            for (j = k; j <= n; j++) {
+                double t = a[k][j];
+                a[k][j] = a[pivot][j];
+                a[pivot][j] = t;
+            }
+        }
+        for (i = k + 1; i < n; i++) {
+            double f = a[i][k] / a[k][k];
+            for (j = k; j <= n; j++) a[i][j] -= f * a[k][j];
+        }
+    }
+    for (i = n - 1; i >= 0; i--) {
+        double v = a[i][n];
+        for (j = i + 1; j < n; j++) v -= a[i][j] * model->params[j];
+        model->params[i] = v / a[i][i];
+    }
+    return 0;
+}
+
+/**
+ * the coefficient of determination of the fit, from the accumulated sums: SSE = y'y - 2*params'X'y + params'X'X*params
+ */
+static double rtune_model_r2(const rtune_model_t * model) {
+    int n = model->num_params;
+    double sse = model->yty;
+    int i, j;
+    for (i = 0; i < n; i++) {
+        sse -= 2.0 * model->params[i] * model->xty[i];
+        for (j = 0; j < n; j++) sse += model->params[i] * model->xtx[i][j] * model->params[j];
+    }
+    double sst = model->yty - model->sum_y * model->sum_y / model->num_samples;
+    if (sst <= 0.0) return 1.0;
+    if (sse < 0.0) sse = 0.0;
+    return 1.0 - sse / sst;
+}
+
+/**
+ * accumulate a sample into the normal equations and refit the model
+ */
+void rtune_model_add_sample(rtune_model_t * model, double x, double y) {
+    double features[RTUNE_MODEL_MAX_PARAMS];
+    rtune_model_features(model, x, features);
+    double target = rtune_model_target(model, x, y);
+    int n = model->num_params;
+    int i, j;
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++) model->xtx[i][j] += features[i] * features[j];
+        model->xty[i] += features[i] * target;
+    }
+    model->yty += target * target;
+    model->sum_y += target;
+    model->num_samples++;
+
+    model->fitted = model->num_samples >= n && rtune_model_solve(model) == 0;
+    if (model->fitted) model->r2 = rtune_model_r2(model);
+    model->modeled = model->fitted && model->num_samples > n && model->r2 >= model->r2_threshold;
+}
+
+double rtune_model_predict(const rtune_model_t * model, double x) {
+    double features[RTUNE_MODEL_MAX_PARAMS];
+    rtune_model_features(model, x, features);
+    double y = 0.0;
+    int i;
+    for (i = 0; i < model->num_params; i++) y += model->params[i] * features[i];
+    if (model->kind == RTUNE_MODEL_USL) return x > 0.0 ? y / x : 0.0;
+    return y;
+}
+
+/**
+ * The optimum is one of the bounds or a stationary point of the model within them. For USL, the exe time
+ * T(N) = (params[0]-params[1])/N + params[1] - params[2] + params[2]*N is stationary at N = sqrt((params[0]-params[1])/params[2]),
+ * which is the throughput-optimal number of threads if the coherency cost params[2] is positive. A quadratic is
+ * stationary at its vertex, and a linear model only has its optimum at a bound.
+ */
+int rtune_model_optimum(const rtune_model_t * model, int maximize, double lo, double hi, double * x) {
+    if (!model->fitted) return -1;
+    double candidates[3] = {lo, hi, lo};
+    int num_candidates = 2;
+    double stationary = lo;
+    if (model->kind == RTUNE_MODEL_USL && model->params[2] != 0.0) {
+        double n2 = (model->params[0] - model->params[1]) / model->params[2];
+        if (n2 > 0.0) stationary = sqrt(n2);
+    } else if ((model->kind == RTUNE_MODEL_QUADRATIC || model->kind == RTUNE_MODEL_UNIMODAL) && model->params[2] != 0.0) {
+        stationary = model->x_shift - model->x_scale * model->params[1] / (2.0 * model->params[2]);
+    }
+    if (stationary > lo && stationary < hi) candidates[num_candidates++] = stationary;
+
+    int i;
+    int best = 0;
+    double best_y = rtune_model_predict(model, candidates[0]);
+    for (i = 1; i < num_candidates; i++) {
+        double y = rtune_model_predict(model, candidates[i]);
+        if (maximize ? y > best_y : y < best_y) {
+            best = i;
+            best_y = y;
+        }
+    }
+    *x = candidates[best];
+    return 0;
+}
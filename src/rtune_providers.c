@@ -0,0 +1,517 @@
+#include <pthread.h>
+#include <time.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <sys/resource.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "rtune_providers.h"
+
+#ifdef RTUNE_HAVE_TSC
+#include <cpuid.h>
+#endif
+
+#define RTUNE_TSC_CALIBRATION_NS 10000000 //time to calibrate the TSC frequency against the monotonic raw clock
+
+int rtune_tsc_invariant = 0;
+static double rtune_tsc_cycles_per_ns = 1.0;
+static pthread_once_t rtune_timer_once = PTHREAD_ONCE_INIT;
+
+/**
+ * use the TSC for rtune_timer_cycles only if it is invariant, i.e. it ticks at a constant rate across P/C-states, and
+ * calibrate its frequency. Otherwise the cycle timer falls back to nanoseconds.
+ */
+static void rtune_timer_calibrate(void) {
+#ifdef RTUNE_HAVE_TSC
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 8))) return;
+
+    struct timespec interval = {0, RTUNE_TSC_CALIBRATION_NS};
+    double ns0 = rtune_timer_ns_inline();
+    unsigned long long cycles0 = __rdtsc();
+    nanosleep(&interval, NULL);
+    double ns1 = rtune_timer_ns_inline();
+    unsigned long long cycles1 = __rdtsc();
+    if (ns1 <= ns0 || cycles1 <= cycles0) return;
+
+    rtune_tsc_cycles_per_ns = (double) (cycles1 - cycles0) / (ns1 - ns0);
+    rtune_tsc_invariant = 1;
+#endif
+}
+
+void rtune_timer_init(void) {
+    pthread_once(&rtune_timer_once, rtune_timer_calibrate);
+}
+
+double rtune_timer_ns(void * arg) {
+    (void) arg;
+    return rtune_timer_ns_inline();
+}
+
+double rtune_timer_ms(void * arg) {
+    (void) arg;
+    return rtune_timer_ns_inline() * 1e-6;
+}
+
+double rtune_timer_cycles(void * arg) {
+    (void) arg;
+    rtune_timer_init();
+    return rtune_timer_cycles_inline();
+}
+
+double rtune_timer_cycles_per_ns(void) {
+    rtune_timer_init();
+    return rtune_tsc_cycles_per_ns;
+}
+
+/**
+ * find out how the value of an ext var/func is read from its provider, see rtune_provider_kind_t. The TSC is calibrated
+ * here for the cycle timer so the calibration is done when the func is added, not in the region.
+ */
+rtune_provider_kind_t rtune_provider_kind_of(void *(*provider) (void *), void * provider_arg) {
+    if (provider == NULL) return RTUNE_PROVIDER_NONE;
+    if ((void *) provider == provider_arg) return RTUNE_PROVIDER_POINTER;
+    if (provider == RTUNE_TIMER_NS) return RTUNE_PROVIDER_TIMER_NS;
+    if (provider == RTUNE_TIMER_MS) return RTUNE_PROVIDER_TIMER_MS;
+    if (provider == RTUNE_TIMER_CYCLES) {
+        rtune_timer_init();
+        return RTUNE_PROVIDER_TIMER_CYCLES;
+    }
+    if (provider == RTUNE_PERF_COUNTER) return RTUNE_PROVIDER_PERF_COUNTER;
+    if (provider == RTUNE_RUSAGE) return RTUNE_PROVIDER_RUSAGE;
+    if (provider == RTUNE_ENERGY) return RTUNE_PROVIDER_ENERGY;
+    return RTUNE_PROVIDER_FUNC;
+}
+
+#ifdef __linux__
+static const struct {
+    uint32_t type;
+    uint64_t config;
+    int fallback; //the software event to count if the hardware event cannot be opened, -1 if none
+} rtune_perf_events[RTUNE_PERF_NUM_EVENTS] = {
+    [RTUNE_PERF_CYCLES]           = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, RTUNE_PERF_TASK_CLOCK},
+    [RTUNE_PERF_INSTRUCTIONS]     = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, -1},
+    [RTUNE_PERF_CACHE_REFERENCES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES, -1},
+    [RTUNE_PERF_LLC_MISSES]       = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, -1},
+    [RTUNE_PERF_BRANCH_MISSES]    = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, -1},
+    [RTUNE_PERF_TASK_CLOCK]       = {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, -1},
+    [RTUNE_PERF_CONTEXT_SWITCHES] = {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, -1},
+    [RTUNE_PERF_PAGE_FAULTS]      = {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, -1},
+    [RTUNE_PERF_CPU_MIGRATIONS]   = {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS, -1},
+};
+
+/**
+ * open an event in the group, the first one opened becomes the leader. Kernel events are excluded for hardware events
+ * so they can be opened with the default perf_event_paranoid. Inheritance is given up if the kernel cannot read an
+ * inherited group, and kernel counting of software events if it is not allowed.
+ * @return the fd, or -1 if the event cannot be opened
+ */
+static int rtune_perf_event_open(rtune_perf_group_t *group, rtune_perf_event_t event) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = rtune_perf_events[event].type;
+    attr.config = rtune_perf_events[event].config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_kernel = attr.type == PERF_TYPE_HARDWARE;
+    attr.exclude_hv = 1;
+    attr.inherit = group->inherit;
+
+    while (1) {
+        int fd = (int) syscall(__NR_perf_event_open, &attr, 0, -1, group->leader_fd, PERF_FLAG_FD_CLOEXEC);
+        if (fd >= 0) return fd;
+        if (errno == EINVAL && attr.inherit && group->leader_fd < 0) {
+            attr.inherit = group->inherit = 0;
+        } else if ((errno == EACCES || errno == EPERM) && !attr.exclude_kernel) {
+            attr.exclude_kernel = 1;
+        } else {
+            return -1;
+        }
+    }
+}
+
+/**
+ * read all the counters of the group with one read() of the leader. The values are scaled by time_enabled/time_running
+ * in case the group is multiplexed with other groups on the PMU.
+ */
+static void rtune_perf_group_read(rtune_perf_group_t *group) {
+    uint64_t buf[3 + 2 * RTUNE_PERF_MAX_GROUP_EVENTS]; //nr, time_enabled, time_running, {value, id}[nr]
+    group->read_epoch = group->region->epoch;
+    ssize_t size = read(group->leader_fd, buf, sizeof(buf));
+    if (size < (ssize_t) (3 * sizeof(uint64_t))) return;
+
+    uint64_t nr = buf[0];
+    double scale = buf[2] > 0 ? (double) buf[1] / (double) buf[2] : 0.0;
+    uint64_t i;
+    int j;
+    for (i = 0; i < nr && 3 + 2 * i + 1 < size / sizeof(uint64_t); i++) {
+        for (j = 0; j < group->num_events; j++) {
+            if (group->ids[j] == buf[3 + 2 * i + 1]) {
+                group->values[j] = (double) buf[3 + 2 * i] * scale;
+                break;
+            }
+        }
+    }
+}
+#endif
+
+/**
+ * add a counter of a perf event to the group of the region, the group is created with the first counter. The counter
+ * counts from when it is added, which is fine for the RTUNE_FUNC_EXT_DIFF funcs that use the deltas.
+ * @return the counter, which is not available (see rtune_perf_counter_event) if neither the event nor its fallback can
+ * be opened. NULL if the system runs out of memory
+ */
+rtune_perf_counter_t * rtune_perf_counter_add(rtune_region_t * region, rtune_perf_event_t event) {
+    rtune_perf_group_t *group = region->perf_group;
+    if (group == NULL) {
+        group = (rtune_perf_group_t *) rtune_region_arena_alloc(region, sizeof(rtune_perf_group_t));
+        if (group == NULL) return NULL;
+        group->region = region;
+        group->leader_fd = -1;
+        group->inherit = 1;
+        group->read_epoch = region->epoch - 1;
+        region->perf_group = group;
+    }
+    rtune_perf_counter_t *counter = (rtune_perf_counter_t *) rtune_region_arena_alloc(region, sizeof(rtune_perf_counter_t));
+    if (counter == NULL) return NULL;
+    counter->group = group;
+    counter->event = event;
+    counter->index = -1;
+
+#ifdef __linux__
+    if (event < 0 || event >= RTUNE_PERF_NUM_EVENTS || group->num_events == RTUNE_PERF_MAX_GROUP_EVENTS) return counter;
+    int fd = rtune_perf_event_open(group, event);
+    if (fd < 0 && rtune_perf_events[event].fallback >= 0) {
+        counter->event = (rtune_perf_event_t) rtune_perf_events[event].fallback;
+        fd = rtune_perf_event_open(group, counter->event);
+    }
+    if (fd < 0) return counter;
+
+    uint64_t id;
+    if (ioctl(fd, PERF_EVENT_IOC_ID, &id) < 0) {
+        close(fd);
+        return counter;
+    }
+    if (group->leader_fd < 0) group->leader_fd = fd;
+    counter->index = group->num_events++;
+    group->fds[counter->index] = fd;
+    group->ids[counter->index] = id;
+    group->read_epoch = region->epoch - 1; //the values cached are of the counters before this one is added
+#endif
+    return counter;
+}
+
+int rtune_perf_counter_event(rtune_perf_counter_t * counter) {
+    return counter->index < 0 ? -1 : (int) counter->event;
+}
+
+/**
+ * the provider of a perf counter, the group of the counter is read if it is not read yet in the current epoch of the region
+ */
+double rtune_perf_counter_read(void * arg) {
+    rtune_perf_counter_t *counter = (rtune_perf_counter_t *) arg;
+    if (counter == NULL || counter->index < 0) return 0.0;
+    rtune_perf_group_t *group = counter->group;
+#ifdef __linux__
+    if (group->read_epoch != group->region->epoch) rtune_perf_group_read(group);
+#endif
+    return group->values[counter->index];
+}
+
+static void rtune_perf_group_close(rtune_perf_group_t * group) {
+    int i;
+    for (i = group->num_events - 1; i >= 0; i--) close(group->fds[i]); //the leader is closed last
+    group->num_events = 0;
+    group->leader_fd = -1;
+}
+
+/**
+ * add a counter of a resource usage field to the region, the source of the field is opened when it is first used
+ * @return the counter, NULL if the system runs out of memory
+ */
+rtune_rusage_counter_t * rtune_rusage_add(rtune_region_t * region, rtune_rusage_field_t field) {
+    rtune_rusage_source_t *source = region->rusage_source;
+    if (source == NULL) {
+        source = (rtune_rusage_source_t *) rtune_region_arena_alloc(region, sizeof(rtune_rusage_source_t));
+        if (source == NULL) return NULL;
+        source->region = region;
+        source->proc_fd = -1;
+        region->rusage_source = source;
+    }
+    rtune_rusage_counter_t *counter = (rtune_rusage_counter_t *) rtune_region_arena_alloc(region, sizeof(rtune_rusage_counter_t));
+    if (counter == NULL) return NULL;
+    counter->source = source;
+    counter->field = field;
+
+    if (field >= RTUNE_PROC_RSS) {
+        if (source->proc_fd < 0) source->proc_fd = open("/proc/self/stat", O_RDONLY | O_CLOEXEC);
+    } else {
+        source->use_rusage = 1;
+    }
+    source->read_epoch = region->epoch - 1; //read the new field in the current epoch too
+    return counter;
+}
+
+/**
+ * parse the fields of /proc/self/stat, see proc(5). The fields are counted after the comm field, which is in parentheses
+ * and may contain spaces
+ */
+static void rtune_proc_stat_parse(rtune_rusage_source_t *source, char *buf) {
+    static long page_kb = 0;
+    if (page_kb == 0) page_kb = sysconf(_SC_PAGESIZE) / 1024;
+    char *p = strrchr(buf, ')');
+    if (p == NULL) return;
+    int field = 2; //the comm field
+    while (*p != '\0') {
+        if (*p++ != ' ') continue;
+        field++;
+        if (field == 20) source->values[RTUNE_PROC_NUM_THREADS] = (double) strtol(p, NULL, 10);
+        else if (field == 23) source->values[RTUNE_PROC_VSIZE] = (double) (strtoul(p, NULL, 10) / 1024);
+        else if (field == 24) {
+            source->values[RTUNE_PROC_RSS] = (double) (strtol(p, NULL, 10) * page_kb);
+            break;
+        }
+    }
+}
+
+static void rtune_rusage_source_read(rtune_rusage_source_t *source) {
+    source->read_epoch = source->region->epoch;
+    if (source->use_rusage) {
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+            source->values[RTUNE_RUSAGE_MAX_RSS] = (double) usage.ru_maxrss;
+            source->values[RTUNE_RUSAGE_MINOR_FAULTS] = (double) usage.ru_minflt;
+            source->values[RTUNE_RUSAGE_MAJOR_FAULTS] = (double) usage.ru_majflt;
+            source->values[RTUNE_RUSAGE_VOLUNTARY_CSW] = (double) usage.ru_nvcsw;
+            source->values[RTUNE_RUSAGE_INVOLUNTARY_CSW] = (double) usage.ru_nivcsw;
+            source->values[RTUNE_RUSAGE_USER_TIME] = usage.ru_utime.tv_sec * 1e3 + usage.ru_utime.tv_usec * 1e-3;
+            source->values[RTUNE_RUSAGE_SYSTEM_TIME] = usage.ru_stime.tv_sec * 1e3 + usage.ru_stime.tv_usec * 1e-3;
+        }
+    }
+    if (source->proc_fd >= 0) {
+        char buf[1024];
+        ssize_t size = pread(source->proc_fd, buf, sizeof(buf) - 1, 0);
+        if (size > 0) {
+            buf[size] = '\0';
+            rtune_proc_stat_parse(source, buf);
+        }
+    }
+}
+
+/**
+ * the provider of a rusage counter, the sources are read if they are not read yet in the current epoch of the region
+ */
+double rtune_rusage_read(void * arg) {
+    rtune_rusage_counter_t *counter = (rtune_rusage_counter_t *) arg;
+    if (counter == NULL || counter->field < 0 || counter->field >= RTUNE_RUSAGE_NUM_FIELDS) return 0.0;
+    rtune_rusage_source_t *source = counter->source;
+    if (source->read_epoch != source->region->epoch) rtune_rusage_source_read(source);
+    return source->values[counter->field];
+}
+
+static char rtune_sysfs_root[PATH_MAX];
+static pthread_mutex_t rtune_cpufreq_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const char *rtune_sysfs_root_path(void) {
+    if (rtune_sysfs_root[0] != '\0') return rtune_sysfs_root;
+    const char *root = getenv("RTUNE_SYSFS_ROOT");
+    return root != NULL ? root : "/sys";
+}
+
+/**
+ * read an unsigned integer from a sysfs file that is kept open
+ * @return 0 on success, -1 if the file cannot be read
+ */
+static int rtune_sysfs_pread_ull(int fd, unsigned long long *value) {
+    char buf[32];
+    ssize_t size = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (size <= 0) return -1;
+    buf[size] = '\0';
+    *value = strtoull(buf, NULL, 10);
+    return 0;
+}
+
+static int rtune_sysfs_read_ull(const char *path, unsigned long long *value) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    int ret = rtune_sysfs_pread_ull(fd, value);
+    close(fd);
+    return ret;
+}
+
+/**
+ * open the RAPL package zones for the energy provider of the region, the region has one energy source for all its funcs.
+ * The zones are probed before the energy source is allocated from the arena so a region without RAPL can retry for free.
+ */
+rtune_energy_t * rtune_energy_add(rtune_region_t * region) {
+    if (region->energy != NULL) return region->energy;
+    rtune_energy_t probe;
+    memset(&probe, 0, sizeof(probe));
+    probe.region = region;
+
+    char path[PATH_MAX];
+    int i;
+    for (i = 0; i < RTUNE_RAPL_MAX_ZONES; i++) {
+        snprintf(path, sizeof(path), "%s/class/powercap/intel-rapl:%d/energy_uj", rtune_sysfs_root_path(), i);
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) break;
+        int zone = probe.num_zones;
+        snprintf(path, sizeof(path), "%s/class/powercap/intel-rapl:%d/max_energy_range_uj", rtune_sysfs_root_path(), i);
+        if (rtune_sysfs_pread_ull(fd, &probe.last_uj[zone]) < 0 || rtune_sysfs_read_ull(path, &probe.max_range_uj[zone]) < 0) {
+            close(fd);
+            break;
+        }
+        probe.fds[zone] = fd;
+        probe.num_zones++;
+    }
+    if (probe.num_zones == 0) return NULL;
+    rtune_energy_t *energy = (rtune_energy_t *) rtune_region_arena_alloc(region, sizeof(rtune_energy_t));
+    if (energy == NULL) {
+        for (i = 0; i < probe.num_zones; i++) close(probe.fds[i]);
+        return NULL;
+    }
+    *energy = probe;
+    energy->read_epoch = region->epoch;
+    region->energy = energy;
+    return energy;
+}
+
+/**
+ * the energy provider, the zones are read if they are not read yet in the current epoch of the region. A raw read that
+ * is less than the last one means the counter wrapped around to 0 after max_energy_range_uj since the last read.
+ */
+double rtune_energy_read(void * arg) {
+    rtune_energy_t *energy = (rtune_energy_t *) arg;
+    if (energy == NULL) return 0.0;
+    if (energy->read_epoch == energy->region->epoch) return energy->energy;
+    energy->read_epoch = energy->region->epoch;
+
+    int i;
+    for (i = 0; i < energy->num_zones; i++) {
+        unsigned long long uj;
+        if (rtune_sysfs_pread_ull(energy->fds[i], &uj) < 0) continue;
+        unsigned long long last = energy->last_uj[i];
+        unsigned long long delta = uj >= last ? uj - last : energy->max_range_uj[i] - last + uj + 1;
+        energy->energy += delta * 1e-6;
+        energy->last_uj[i] = uj;
+    }
+    return energy->energy;
+}
+
+/**
+ * the cpufreq file of a CPU, which is opened once and written with pwrite. Its value before rtune writes it is saved to
+ * be written back when rtune is done with the file, see rtune_cpufreq_fini.
+ */
+typedef struct rtune_cpufreq_file {
+    int fd;
+    char saved[32]; //the value when the file is opened
+    int saved_len; //0 if the value cannot be read, then it is not written back
+} rtune_cpufreq_file_t;
+
+/**
+ * the cpufreq files of the CPUs, which are process wide since the applier is called with only the frequency. They are
+ * accessed with rtune_cpufreq_lock held since rtune_sysfs_set_root closes them.
+ */
+static rtune_cpufreq_file_t *rtune_cpufreq_files = NULL;
+static int rtune_cpufreq_num_cpus = -1; //-1 if not opened yet
+static int rtune_cpufreq_atexit = 0; //whether rtune_cpufreq_fini is registered to run at exit
+
+/**
+ * write back the saved values of the cpufreq files and close them, with rtune_cpufreq_lock held
+ */
+static void rtune_cpufreq_close(void) {
+    int i;
+    for (i = 0; i < rtune_cpufreq_num_cpus; i++) {
+        rtune_cpufreq_file_t *file = &rtune_cpufreq_files[i];
+        if (file->saved_len > 0 && pwrite(file->fd, file->saved, file->saved_len, 0) < 0) perror("restore cpufreq");
+        close(file->fd);
+    }
+    free(rtune_cpufreq_files);
+    rtune_cpufreq_files = NULL;
+    rtune_cpufreq_num_cpus = -1;
+}
+
+/**
+ * open the cpufreq files of the CPUs and save their values, with rtune_cpufreq_lock held
+ */
+static void rtune_cpufreq_open(void) {
+    long num_cpus = sysconf(_SC_NPROCESSORS_CONF);
+    if (num_cpus < 1) num_cpus = 1;
+    rtune_cpufreq_files = (rtune_cpufreq_file_t *) malloc(sizeof(rtune_cpufreq_file_t) * num_cpus);
+    rtune_cpufreq_num_cpus = 0;
+    if (!rtune_cpufreq_atexit) rtune_cpufreq_atexit = atexit(rtune_cpufreq_fini) == 0;
+
+    char path[PATH_MAX];
+    char governor[32];
+    int cpu;
+    for (cpu = 0; rtune_cpufreq_files != NULL && cpu < num_cpus; cpu++) {
+        snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%d/cpufreq/scaling_governor", rtune_sysfs_root_path(), cpu);
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        ssize_t size = fd < 0 ? -1 : read(fd, governor, sizeof(governor) - 1);
+        if (fd >= 0) close(fd);
+        if (size <= 0) continue;
+        governor[size] = '\0';
+        const char *name = strncmp(governor, "userspace", 9) == 0 ? "scaling_setspeed" : "scaling_max_freq";
+        snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%d/cpufreq/%s", rtune_sysfs_root_path(), cpu, name);
+        fd = open(path, O_RDWR | O_CLOEXEC);
+        if (fd < 0) continue;
+        rtune_cpufreq_file_t *file = &rtune_cpufreq_files[rtune_cpufreq_num_cpus++];
+        file->fd = fd;
+        size = pread(fd, file->saved, sizeof(file->saved), 0);
+        file->saved_len = size > 0 ? (int) size : 0;
+    }
+}
+
+int rtune_cpufreq_init(void) {
+    pthread_mutex_lock(&rtune_cpufreq_lock);
+    if (rtune_cpufreq_num_cpus < 0) rtune_cpufreq_open();
+    int num_cpus = rtune_cpufreq_num_cpus;
+    pthread_mutex_unlock(&rtune_cpufreq_lock);
+    return num_cpus;
+}
+
+void rtune_cpufreq_apply(void * freq_khz) {
+    char buf[32];
+    int len = snprintf(buf, sizeof(buf), "%ld\n", (long) freq_khz);
+    int i;
+    pthread_mutex_lock(&rtune_cpufreq_lock);
+    if (rtune_cpufreq_num_cpus < 0) rtune_cpufreq_open();
+    for (i = 0; i < rtune_cpufreq_num_cpus; i++) {
+        if (pwrite(rtune_cpufreq_files[i].fd, buf, len, 0) < 0) continue; //e.g. out of the range of the CPU
+    }
+    pthread_mutex_unlock(&rtune_cpufreq_lock);
+}
+
+void rtune_cpufreq_fini(void) {
+    pthread_mutex_lock(&rtune_cpufreq_lock);
+    rtune_cpufreq_close();
+    pthread_mutex_unlock(&rtune_cpufreq_lock);
+}
+
+void rtune_sysfs_set_root(const char * root) {
+    pthread_mutex_lock(&rtune_cpufreq_lock);
+    rtune_cpufreq_close(); //the files of the old root are restored, and the new root is opened when it is used next
+    snprintf(rtune_sysfs_root, sizeof(rtune_sysfs_root), "%s", root != NULL ? root : "");
+    pthread_mutex_unlock(&rtune_cpufreq_lock);
+}
+
+void rtune_providers_fini(rtune_region_t * region) {
+    int i;
+    if (region->perf_group != NULL) rtune_perf_group_close(region->perf_group);
+    if (region->rusage_source != NULL && region->rusage_source->proc_fd >= 0) close(region->rusage_source->proc_fd);
+    if (region->energy != NULL) {
+        for (i = 0; i < region->energy->num_zones; i++) close(region->energy->fds[i]);
+    }
+    region->perf_group = NULL;
+    region->rusage_source = NULL;
+    region->energy = NULL;
+}
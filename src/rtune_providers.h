@@ -0,0 +1,118 @@
+#ifndef RTUNE_PROVIDERS_H
+#define RTUNE_PROVIDERS_H
+
+/**
+ * Internal interface of the built-in providers implemented in rtune_providers.c. The runtime recognizes a built-in provider
+ * when an ext var/func is added (see rtune_provider_kind_t) and reads it with the inline readers below in the update path,
+ * without the call through the provider function pointer. This header is not installed.
+ */
+#include <time.h>
+#include "rtune_runtime.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define RTUNE_HAVE_TSC 1
+#endif
+
+#ifdef CLOCK_MONOTONIC_RAW
+#define RTUNE_TIMER_CLOCK CLOCK_MONOTONIC_RAW
+#else
+#define RTUNE_TIMER_CLOCK CLOCK_MONOTONIC
+#endif
+
+#define RTUNE_PROVIDER_BUILTIN(kind) ((kind) >= RTUNE_PROVIDER_TIMER_NS)
+#define RTUNE_PERF_MAX_GROUP_EVENTS 16 //a group is scheduled onto the PMU as a whole, so it cannot have many hardware events anyway
+
+/**
+ * the perf_event group of a region. The first counter opened is the leader, and the group is read with one read() of the
+ * leader in an epoch of the region, the values of all the counters are cached for the other reads in the same epoch.
+ */
+typedef struct rtune_perf_group {
+    rtune_region_t *region;
+    int leader_fd; //-1 if no counter is opened
+    int inherit;   //whether the counters count the threads created afterwards
+    int num_events;
+    int fds[RTUNE_PERF_MAX_GROUP_EVENTS];
+    uint64_t ids[RTUNE_PERF_MAX_GROUP_EVENTS];
+    double values[RTUNE_PERF_MAX_GROUP_EVENTS]; //the values of the last read, scaled by time_enabled/time_running
+    unsigned long read_epoch; //the epoch of the region in which the group is read last
+} rtune_perf_group_t;
+
+struct rtune_perf_counter {
+    rtune_perf_group_t *group;
+    rtune_perf_event_t event; //the event being counted, which may be the fallback of the requested one
+    int index; //index of the counter in the group, -1 if it is not available
+};
+
+/**
+ * the resource usage of the process read for the rusage counters of a region. Only the sources the counters use are read,
+ * each with one syscall in an epoch of the region: getrusage, and a pread of /proc/self/stat that is kept open.
+ */
+typedef struct rtune_rusage_source {
+    rtune_region_t *region;
+    int use_rusage;
+    int proc_fd; //fd of /proc/self/stat, -1 if no counter uses it or it cannot be opened
+    double values[RTUNE_RUSAGE_NUM_FIELDS];
+    unsigned long read_epoch; //the epoch of the region in which the sources are read last
+} rtune_rusage_source_t;
+
+struct rtune_rusage_counter {
+    rtune_rusage_source_t *source;
+    rtune_rusage_field_t field;
+};
+
+#define RTUNE_RAPL_MAX_ZONES 8 //max number of RAPL packages, i.e. sockets
+
+/**
+ * the RAPL package zones of a region, the energy_uj of each zone is kept open and read with pread
+ */
+struct rtune_energy {
+    rtune_region_t *region;
+    int num_zones;
+    int fds[RTUNE_RAPL_MAX_ZONES];
+    unsigned long long last_uj[RTUNE_RAPL_MAX_ZONES]; //the last raw read of the zone
+    unsigned long long max_range_uj[RTUNE_RAPL_MAX_ZONES]; //the range of energy_uj, after which it wraps around to 0
+    double energy; //joules accumulated since the zones are opened
+    unsigned long read_epoch;
+};
+
+extern int rtune_tsc_invariant; //whether rtune_timer_cycles reads the TSC, set by rtune_timer_init
+
+void rtune_timer_init(void); //check and calibrate the TSC, only once
+rtune_provider_kind_t rtune_provider_kind_of(void *(*provider) (void *), void * provider_arg);
+void rtune_providers_fini(rtune_region_t * region); //close the providers of a region when it is finalized
+void *rtune_region_arena_alloc(rtune_region_t * region, size_t size); //see rtune_arena_alloc
+
+static inline double rtune_timer_ns_inline(void) {
+    struct timespec ts;
+    clock_gettime(RTUNE_TIMER_CLOCK, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+static inline double rtune_timer_cycles_inline(void) {
+#ifdef RTUNE_HAVE_TSC
+    if (rtune_tsc_invariant) return (double) __rdtsc();
+#endif
+    return rtune_timer_ns_inline();
+}
+
+static inline double rtune_provider_read_builtin(rtune_provider_kind_t kind, void * provider_arg) {
+    switch (kind) {
+        case RTUNE_PROVIDER_TIMER_NS:
+            return rtune_timer_ns_inline();
+        case RTUNE_PROVIDER_TIMER_MS:
+            return rtune_timer_ns_inline() * 1e-6;
+        case RTUNE_PROVIDER_TIMER_CYCLES:
+            return rtune_timer_cycles_inline();
+        case RTUNE_PROVIDER_PERF_COUNTER:
+            return rtune_perf_counter_read(provider_arg);
+        case RTUNE_PROVIDER_RUSAGE:
+            return rtune_rusage_read(provider_arg);
+        case RTUNE_PROVIDER_ENERGY:
+            return rtune_energy_read(provider_arg);
+        default:
+            return 0.0;
+    }
+}
+
+#endif
@@ -8,70 +8,416 @@
 #include <stdarg.h>
 #include <math.h>
 #include <float.h>
+#define RTUNE_NO_INLINE_FASTPATH //the library implements the functions that the inline fast path calls
 #include "rtune_runtime.h"
+#include "rtune_providers.h"
 
 /**
- * This is not thread-safe
+ * A block of a region arena. The data of the block follows the header, which is padded to a cache line so the data is
+ * cache-line aligned too.
  */
-rtune_region_t rtune_regions[MAX_NUM_REGIONS]; //assume all global variable/mem are initialized 0, not thread-safe
+typedef struct rtune_arena_block {
+    struct rtune_arena_block *next; //the block allocated before this one
+    size_t size; //bytes of the data
+    size_t used;
+} __attribute__((aligned(RTUNE_CACHE_LINE_SIZE))) rtune_arena_block_t;
+
+static rtune_arena_block_t *rtune_arena_block_new(size_t size, rtune_arena_block_t *next) {
+    void *mem = NULL;
+    if (posix_memalign(&mem, RTUNE_CACHE_LINE_SIZE, sizeof(rtune_arena_block_t) + size) != 0) return NULL;
+    rtune_arena_block_t *block = (rtune_arena_block_t *) mem;
+    block->next = next;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+/**
+ * allocate a zeroed, cache-line aligned buffer from the arena. A new block, at least twice as large as the current one,
+ * is chained in when the current block is full.
+ * @return the buffer, or NULL if the system runs out of memory
+ */
+static void *rtune_arena_alloc(rtune_arena_t *arena, size_t size) {
+    size = (size + RTUNE_CACHE_LINE_SIZE - 1) & ~((size_t) RTUNE_CACHE_LINE_SIZE - 1);
+    rtune_arena_block_t *block = arena->head;
+    if (block == NULL || block->used + size > block->size) {
+        size_t block_size = block == NULL ? DEFAULT_REGION_ARENA_SIZE : block->size * 2;
+        while (block_size < size) block_size *= 2;
+        block = rtune_arena_block_new(block_size, block);
+        if (block == NULL) return NULL;
+        arena->head = block;
+    }
+    void *ptr = (char *) (block + 1) + block->used;
+    block->used += size;
+    arena->used += size;
+    if (arena->used > arena->high_water) arena->high_water = arena->used;
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+void *rtune_region_arena_alloc(rtune_region_t *region, size_t size) {
+    return rtune_arena_alloc(&region->arena, size);
+}
+
+/**
+ * grow an array allocated from the arena by doubling its capacity, the elements are copied to the new array. The old
+ * array is not freed individually, it is released with the arena.
+ * @return the new array, or the old one unchanged if the system runs out of memory
+ */
+static void *rtune_arena_grow(rtune_arena_t *arena, void *array, size_t elem_size, int num, int *capacity) {
+    int new_capacity = *capacity == 0 ? DEFAULT_NUM_REGION_ENTRIES : *capacity * 2;
+    void *new_array = rtune_arena_alloc(arena, elem_size * new_capacity);
+    if (new_array == NULL) return array;
+    if (num > 0) memcpy(new_array, array, elem_size * num);
+    *capacity = new_capacity;
+    return new_array;
+}
+
+//make sure the array has room for one more element, evaluated to 0 if it cannot grow
+#define RTUNE_ARRAY_RESERVE(arena, array, num, capacity) \
+    ((num) < (capacity) || ((array) = rtune_arena_grow(arena, array, sizeof(*(array)), num, &(capacity)), (num) < (capacity)))
+
+/**
+ * release all the buffers of the arena at once. If the arena has grown into more than one block, the blocks are
+ * coalesced into a single one that holds the high water mark so a region reusing the arena allocates from one block.
+ */
+static void rtune_arena_reset(rtune_arena_t *arena) {
+    rtune_arena_block_t *block = arena->head;
+    if (block == NULL) return;
+    if (block->next != NULL) {
+        while (block != NULL) {
+            rtune_arena_block_t *next = block->next;
+            free(block);
+            block = next;
+        }
+        size_t block_size = DEFAULT_REGION_ARENA_SIZE;
+        while (block_size < arena->high_water) block_size *= 2;
+        arena->used = 0; //before the new block, which may fail and leave the arena empty
+        block = arena->head = rtune_arena_block_new(block_size, NULL);
+        if (block == NULL) return;
+    }
+    block->used = 0;
+    arena->used = 0;
+}
+
+/**
+ * return all the blocks of the arena to the system, e.g. when its region is freed
+ */
+static void rtune_arena_free(rtune_arena_t *arena) {
+    rtune_arena_block_t *block = arena->head;
+    while (block != NULL) {
+        rtune_arena_block_t *next = block->next;
+        free(block);
+        block = next;
+    }
+    memset(arena, 0, sizeof(rtune_arena_t));
+}
+
+/**
+ * The region registry is an open-addressing hash table of region pointers keyed by (name, codeptr_ra), with linear probing.
+ * Lookup is lock-free: a reader loads the current table and probes its slots with acquire loads. Insertion, removal and growth
+ * are serialized by rtune_region_lock. When the table grows, a new table is filled and then published atomically. The replaced
+ * table is kept in the retired list of the new table so a reader that still probes it never touches freed memory.
+ * A removed region leaves a tombstone in its slot so that the probing chain of other regions is not broken, and the tombstone
+ * is reused by the next region inserted into that chain.
+ *
+ * A reader may still probe a region it loaded before the region is removed, so the key of a region (name, codeptr_ra and
+ * key_hash) is never written while a reader can reach it. A finalized region is kept in limbo, and the retired tables are
+ * kept, until no lookup is in progress (see rtune_region_reclaim). Then the region is reused by a new region of any key, or
+ * freed. The name is copied so the key does not depend on the string of the caller.
+ */
+typedef struct rtune_region_table {
+    unsigned long num_slots; //power of 2
+    unsigned long num_used;  //live regions plus tombstones
+    struct rtune_region_table *retired; //the table this one replaced
+    rtune_region_t *slots[];
+} rtune_region_table_t;
+
+#define RTUNE_REGION_TOMBSTONE ((rtune_region_t *) 1)
+#define RTUNE_BITS_PER_WORD ((int) (8 * sizeof(unsigned long))) //bits of a word of the bitsets, e.g. rtune_region_t::dirty_funcs
+#define RTUNE_OPERAND_FUNC (-1) //rtune_func_t::operand_columns of a func operand, which is read at its state of the update
+#define RTUNE_OPERAND_VALUE (-2) //rtune_func_t::operand_columns of a var operand that is read at its current value
+
+static rtune_region_table_t *rtune_region_table;
+static pthread_mutex_t rtune_region_lock = PTHREAD_MUTEX_INITIALIZER;
+//regions finalized and tables replaced in the current epoch and in the previous one, which lock-free lookups may still probe
+static rtune_region_t *rtune_region_limbo[2];
+static rtune_region_table_t *rtune_region_retired_tables; //replaced in the previous epoch, see rtune_region_reclaim
+static unsigned long rtune_region_epoch;
+static int rtune_region_readers[2]; //lock-free lookups in progress that started in an even or an odd epoch
+static rtune_region_t *rtune_region_free_list; //finalized regions that no lookup can reach, reused by new regions
+static int rtune_region_num_free;
 int num_regions;
 
+static unsigned long rtune_region_hash(const char *name, const void *codeptr_ra) {
+    unsigned long h = 14695981039346656037UL; //FNV-1a
+    if (name != NULL) {
+        while (*name) {
+            h ^= (unsigned char) *name++;
+            h *= 1099511628211UL;
+        }
+    }
+    h ^= (unsigned long) codeptr_ra;
+    h *= 1099511628211UL;
+    return h ^ (h >> 29);
+}
+
+static int rtune_region_match(rtune_region_t *region, unsigned long hash, const char *name, const void *codeptr_ra) {
+    if (region->key_hash != hash || region->codeptr_ra != codeptr_ra) return 0;
+    if (name == NULL || region->name == NULL) return name == region->name;
+    return strcmp(region->name, name) == 0;
+}
+
+static rtune_region_t *rtune_region_table_find(rtune_region_table_t *table, unsigned long hash, const char *name, const void *codeptr_ra) {
+    if (table == NULL) return NULL;
+    unsigned long mask = table->num_slots - 1;
+    unsigned long i;
+    for (i = hash & mask; ; i = (i + 1) & mask) {
+        rtune_region_t *region = __atomic_load_n(&table->slots[i], __ATOMIC_ACQUIRE);
+        if (region == NULL) return NULL; //end of the probing chain
+        if (region != RTUNE_REGION_TOMBSTONE && rtune_region_match(region, hash, name, codeptr_ra)) return region;
+    }
+}
+
+static void rtune_region_table_put(rtune_region_table_t *table, rtune_region_t *region) {
+    unsigned long mask = table->num_slots - 1;
+    unsigned long i = region->key_hash & mask;
+    //a tombstone is reused since the region is known not to be in the table. A reader probing for another region just
+    //passes the slot as before, so a region that is finalized and created again does not use up the table
+    while (table->slots[i] != NULL && table->slots[i] != RTUNE_REGION_TOMBSTONE) i = (i + 1) & mask;
+    if (table->slots[i] == NULL) table->num_used++;
+    __atomic_store_n(&table->slots[i], region, __ATOMIC_RELEASE);
+}
+
 /**
- * @brief Initialize a rtune region
- * 
- * @param name 
- * @return rtune_region_t* 
+ * grow (or rebuild to drop tombstones) the table if one more region would make it more than half full. Called with the lock held.
  */
-rtune_region_t *rtune_region_init(char *name) {
-    if (name == NULL) {
-        return NULL; //a name must be provided;
+static rtune_region_table_t *rtune_region_table_reserve(void) {
+    rtune_region_table_t *table = rtune_region_table;
+    if (table != NULL && (table->num_used + 1) * 2 <= table->num_slots) return table;
+
+    unsigned long num_slots = DEFAULT_NUM_REGION_SLOTS;
+    while ((unsigned long) num_regions * 4 >= num_slots) num_slots *= 2; //live regions take at most a quarter of the new table
+    rtune_region_table_t *new_table = (rtune_region_table_t *) calloc(1, sizeof(rtune_region_table_t) + num_slots * sizeof(rtune_region_t *));
+    if (new_table == NULL) return NULL;
+    new_table->num_slots = num_slots;
+    new_table->retired = table;
+    if (table != NULL) {
+        unsigned long i;
+        for (i = 0; i < table->num_slots; i++) {
+            rtune_region_t *region = table->slots[i];
+            if (region != NULL && region != RTUNE_REGION_TOMBSTONE) rtune_region_table_put(new_table, region);
+        }
     }
-    int i;
-    for (i = 0; i < MAX_NUM_REGIONS; i++) {
-        rtune_region_t *region = &rtune_regions[i]; //not thread safe
-        if (region->name == NULL) {
+    __atomic_store_n(&rtune_region_table, new_table, __ATOMIC_RELEASE);
+    return new_table;
+}
+
+/**
+ * lock-free find of a region in the current table. The lookup is counted in the readers of the epoch it starts in while
+ * it probes, so the regions and the tables it may reach are not reclaimed, see rtune_region_reclaim
+ */
+static rtune_region_t *rtune_region_find(unsigned long hash, const char *name, const void *codeptr_ra) {
+    unsigned long epoch;
+    int *readers;
+    while (1) {
+        epoch = __atomic_load_n(&rtune_region_epoch, __ATOMIC_SEQ_CST);
+        readers = &rtune_region_readers[epoch & 1];
+        __atomic_add_fetch(readers, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&rtune_region_epoch, __ATOMIC_SEQ_CST) == epoch) break; //counted in the epoch it starts in
+        __atomic_sub_fetch(readers, 1, __ATOMIC_RELEASE);
+    }
+    rtune_region_t *region = rtune_region_table_find(__atomic_load_n(&rtune_region_table, __ATOMIC_ACQUIRE), hash, name, codeptr_ra);
+    __atomic_sub_fetch(readers, 1, __ATOMIC_RELEASE);
+    return region;
+}
+
+/**
+ * Reclaim the regions finalized and the tables replaced in the previous epoch once the lookups that started in that epoch
+ * are done, since a lookup that starts in the current epoch loads the current table, in which they cannot be reached.
+ * The epoch then advances so the ones of the current epoch are reclaimed next time. The lookups that start meanwhile are
+ * counted for the new epoch, so a steady stream of lookups does not hold back the reclamation. Up to
+ * DEFAULT_NUM_FREE_REGIONS regions are kept with their arena in the free list to be reused by new regions of any key, the
+ * others are freed. Called with the lock held at each creation and finalization of a region.
+ */
+static void rtune_region_reclaim(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST); //the tombstones and the new table are visible before the readers are checked
+    unsigned long epoch = __atomic_load_n(&rtune_region_epoch, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&rtune_region_readers[(epoch - 1) & 1], __ATOMIC_SEQ_CST) != 0) return;
+
+    while (rtune_region_retired_tables != NULL) {
+        rtune_region_table_t *next = rtune_region_retired_tables->retired;
+        free(rtune_region_retired_tables);
+        rtune_region_retired_tables = next;
+    }
+    while (rtune_region_limbo[(epoch - 1) & 1] != NULL) {
+        rtune_region_t *region = rtune_region_limbo[(epoch - 1) & 1];
+        rtune_region_limbo[(epoch - 1) & 1] = region->next_free;
+        if (rtune_region_num_free < DEFAULT_NUM_FREE_REGIONS) {
+            region->next_free = rtune_region_free_list;
+            rtune_region_free_list = region;
+            rtune_region_num_free++;
+        } else {
+            rtune_arena_free(&region->arena);
+            free(region->name);
+            free(region);
+        }
+    }
+    if (rtune_region_table != NULL) { //the tables replaced in the current epoch
+        rtune_region_retired_tables = rtune_region_table->retired;
+        rtune_region_table->retired = NULL;
+    }
+    __atomic_store_n(&rtune_region_epoch, epoch + 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief lock-free lookup of a region by its name and/or codeptr_ra
+ *
+ * @return the region, or NULL if no region with this key has been initialized
+ */
+rtune_region_t *rtune_region_lookup(const char *name, const void *codeptr_ra) {
+    return rtune_region_find(rtune_region_hash(name, codeptr_ra), name, codeptr_ra);
+}
+
+/**
+ * @brief lookup a region by its name and/or codeptr_ra, and create it if it is not found. This is thread-safe.
+ *
+ * @param name
+ * @param codeptr_ra
+ * @param created if not NULL, set to 1 if the region is created by this call, 0 if the region already exists
+ * @return rtune_region_t*
+ */
+rtune_region_t *rtune_region_get(char *name, const void *codeptr_ra, int *created) {
+    if (created) *created = 0;
+    if (name == NULL && codeptr_ra == NULL) {
+        return NULL; //a name or a codeptr must be provided;
+    }
+    unsigned long hash = rtune_region_hash(name, codeptr_ra);
+    rtune_region_t *region = rtune_region_find(hash, name, codeptr_ra);
+    if (region != NULL) return region;
+
+    pthread_mutex_lock(&rtune_region_lock);
+    region = rtune_region_table_find(rtune_region_table, hash, name, codeptr_ra); //check again in case another thread just created it
+    if (region == NULL) {
+        rtune_region_table_t *table = rtune_region_table_reserve();
+        char *key_name = NULL;
+        if (table != NULL) {
+            rtune_region_reclaim();
+            region = rtune_region_free_list;
+            if (region != NULL) {
+                rtune_region_free_list = region->next_free;
+                rtune_region_num_free--;
+            } else {
+                region = (rtune_region_t *) calloc(1, sizeof(rtune_region_t));
+            }
+        }
+        if (region != NULL && name != NULL && (key_name = strdup(name)) == NULL) { //back to the free list
+            region->next_free = rtune_region_free_list;
+            rtune_region_free_list = region;
+            rtune_region_num_free++;
+            region = NULL;
+        }
+        if (region != NULL) {
+            rtune_arena_t arena = region->arena; //a reused region keeps its arena, which is resetted when the region is finalized
+            free(region->name); //no lookup can reach a region in the free list, so its key can be changed
             memset(region, 0, sizeof(rtune_region_t));
-            region->name = name;
+            region->arena = arena;
+            region->name = key_name;
+            region->codeptr_ra = codeptr_ra;
+            region->key_hash = hash;
+            region->rng_state = rtune_region_hash(name, NULL); //by name only, so the random updates are the same in each run
             region->count = -1;
             region->num_vars = 0;
             region->num_objs = 0;
             region->num_retired_objs = 0;
             region->status = RTUNE_STATUS_CREATED;
+            region->hot_status = RTUNE_REGION_HOT_TUNING;
+            rtune_region_table_put(table, region); //publish the region only after it is fully initialized
             num_regions++;
-            return region;
+            if (created) *created = 1;
         }
     }
-    return NULL;
+    pthread_mutex_unlock(&rtune_region_lock);
+    return region;
+}
+
+/**
+ * @brief Initialize a rtune region, or return the region that is already initialized with the same name
+ * 
+ * @param name 
+ * @return rtune_region_t* 
+ */
+rtune_region_t *rtune_region_init(char *name) {
+    if (name == NULL) {
+        return NULL; //a name must be provided;
+    }
+    return rtune_region_get(name, NULL, NULL);
 }
 
 void rtune_region_fini(rtune_region_t *region) {
-    region->name = NULL;
-    num_regions--; //not thread-safe
+    if (region == NULL) return;
+    pthread_mutex_lock(&rtune_region_lock);
+    rtune_region_table_t *table = rtune_region_table;
+    if (table == NULL) { //no region has been created
+        pthread_mutex_unlock(&rtune_region_lock);
+        return;
+    }
+    unsigned long mask = table->num_slots - 1;
+    unsigned long i;
+    for (i = region->key_hash & mask; table->slots[i] != NULL; i = (i + 1) & mask) {
+        if (table->slots[i] == region) {
+            __atomic_store_n(&table->slots[i], RTUNE_REGION_TOMBSTONE, __ATOMIC_RELEASE);
+            region->hot_status = 0;
+            rtune_providers_fini(region);
+            rtune_arena_reset(&region->arena); //all the buffers of the region are released at once
+            unsigned long epoch = rtune_region_epoch; //the key is kept until no lookup can reach the region
+            region->next_free = rtune_region_limbo[epoch & 1];
+            rtune_region_limbo[epoch & 1] = region;
+            num_regions--;
+            break;
+        }
+    }
+    rtune_region_reclaim();
+    pthread_mutex_unlock(&rtune_region_lock);
+}
+
+/**
+ * the setup of the region is changed, its schedule needs to be recompiled and the region needs to be tuning
+ */
+static inline void rtune_region_mark_dirty(rtune_region_t *region) {
+    region->sched_dirty = 1;
+    region->hot_status |= RTUNE_REGION_HOT_TUNING;
 }
 
+/**
+ * Operations on the states of a stvar that are specialized for its data type. The ops are bound to the stvar when it is
+ * created (see rtune_malloc_4_states) so that reading, updating and searching the states run typed code without
+ * switching on the type for each call.
+ */
+typedef struct rtune_stvar_ops {
+    size_t size; //size of a state
+    utype_t (*get_value) (stvar_t *stvar, int index);
+    utype_t (*read) (void *(*provider) (void *), void *provider_arg); //read from a pointer or a function, see STVAR_GET_NEXT_STATE
+    int (*equal) (utype_t a, utype_t b);
+    void (*update_list) (rtune_var_t *var, int index);
+    void (*update_range) (rtune_var_t *var, int index);
+    void (*update_ext_straight) (stvar_t *stvar);
+    void (*update_ext_accu4Begin) (stvar_t *stvar, int update);
+    void (*update_diff_base4Diff) (stvar_t *stvar);
+    void (*update_ext_accu4End) (stvar_t *stvar, int update);
+    void (*update_diff_accu4Diff) (stvar_t *stvar, int update);
+    int (*find_min) (stvar_t *stvar, int start, int count, utype_t *minValue);
+    int (*find_max) (stvar_t *stvar, int start, int count, utype_t *maxValue);
+    void (*put) (void *states, int index, utype_t v); //store a value into a typed array such as a column
+    void (*push) (stvar_t *stvar, utype_t v); //update the stvar with a new state
+    double (*to_double) (utype_t v);
+    utype_t (*from_double) (double x);
+} rtune_stvar_ops_t;
+
+static const rtune_stvar_ops_t *rtune_stvar_ops_of(rtune_data_type_t type);
+
 inline static utype_t rtune_stvar_get_value(stvar_t *stvar, int index) {
-	utype_t v;
-	switch (stvar->type) {
-	case RTUNE_short:
-		v = (utype_t)((short*) stvar->states)[index];
-		break;
-	case RTUNE_int:
-		v = (utype_t)((int*) stvar->states)[index];
-		break;
-	case RTUNE_long:
-		v = (utype_t)((long*) stvar->states)[index];
-		break;
-	case RTUNE_float:
-		v = (utype_t)((float*) stvar->states)[index];
-		break;
-	case RTUNE_double:
-		v = (utype_t)((double*) stvar->states)[index];
-		break;
-	default:
-		v = (utype_t)((void**) stvar->states)[index];
-		break;
-	}
-	return v;
+	return stvar->ops->get_value(stvar, index);
 }
 
 utype_t rtune_var_get_value(rtune_var_t * var, int index) {
@@ -82,35 +428,36 @@ utype_t rtune_func_get_value(rtune_func_t * func, int index) {
 	return rtune_stvar_get_value(&(func->stvar), index);
 }
 
-static void * rtune_malloc_4_states(stvar_t *stvar) {
-    //allocate memory for storing the state of the variable
-    int var_size = 2;
-    switch (stvar->type) {
-        case RTUNE_short:
-            var_size = sizeof(short); break;
-        case RTUNE_int:
-            var_size = sizeof(int); break;
-        case RTUNE_long:
-            var_size = sizeof(long); break;
-        case RTUNE_float:
-            var_size = sizeof(float); break;
-        case RTUNE_double:
-            var_size = sizeof(double); break;
-        case RTUNE_void:
-            var_size = sizeof(void *); break;
-        default:
-            var_size = sizeof(void *); break;
-    }
-    stvar->states = (void *)malloc(stvar->total_num_states * var_size);
+static void * rtune_malloc_4_states(rtune_region_t *region, stvar_t *stvar) {
+    //the type of the stvar is known now, bind the typed ops and allocate memory for storing the states of the variable
+    stvar->ops = rtune_stvar_ops_of(stvar->type);
+    stvar->stats.ewma_alpha = DEFAULT_EWMA_alpha;
+    size_t var_size = stvar->ops->size;
+    stvar->states = rtune_arena_alloc(&region->arena, stvar->total_num_states * var_size);
 
     return stvar->states;
 }
 
+/**
+ * allocate a var from the arena of the region and append it to the vars of the region
+ * @return the zeroed var, or NULL if the system runs out of memory
+ */
+static rtune_var_t *rtune_var_new(rtune_region_t *region) {
+    if (!RTUNE_ARRAY_RESERVE(&region->arena, region->vars, region->num_vars, region->max_vars)) return NULL;
+    rtune_var_t *var = (rtune_var_t *) rtune_arena_alloc(&region->arena, sizeof(rtune_var_t));
+    if (var == NULL) return NULL;
+    var->region = region;
+    region->vars[region->num_vars++] = var;
+    rtune_region_mark_dirty(region);
+    return var;
+}
+
 void *rtune_var_add_list(rtune_region_t *region, char *name, int total_num_states, rtune_data_type_t type, int num_values, void *values, char **valname) {
-    int i = region->num_vars;
-    rtune_var_t *var = &region->vars[i];
+    rtune_var_t *var = rtune_var_new(region);
+    if (var == NULL) return NULL;
     var->num_unique_values = num_values;
     var->current_v_index = -1;
+    var->proposed_v_index = -1;
     var->kind = RTUNE_VAR_LIST;
     var->status = RTUNE_STATUS_CREATED;
     var->list_range_setting.list.list_values = values;
@@ -122,6 +469,7 @@ void *rtune_var_add_list(rtune_region_t *region, char *name, int total_num_state
     var->batch_size = DEFAULT_batch_size;
     var->update_iteration_stride = DEFAULT_update_iteration_stride;
     var->apply_policy = DEFAULT_VAR_apply_policy;
+    var->current_apply_index = -1;
 
     stvar_t *stvar = &var->stvar;
     stvar->name = name;
@@ -129,12 +477,11 @@ void *rtune_var_add_list(rtune_region_t *region, char *name, int total_num_state
     stvar->num_states = 0;
     //allocate memory for both states and count_value array
     stvar->total_num_states = total_num_states;
-    var->count_value = (int*) malloc(sizeof(int) * var->num_unique_values);
-    rtune_malloc_4_states(stvar);
+    var->count_value = (int*) rtune_arena_alloc(&region->arena, sizeof(int) * var->num_unique_values);
+    rtune_malloc_4_states(region, stvar);
 
-    //no need to initialize other fields since they are memset as 0 when the region is initialized
+    //no need to initialize other fields since they are zeroed when the var is allocated
 
-    region->num_vars++;
     return (int *)var; //since this is the first field, it has the same address of the object itself (var or stvar)
 }
 
@@ -145,9 +492,10 @@ void *rtune_var_add_list(rtune_region_t *region, char *name, int total_num_state
     var->list_range_setting.range.rangeEnd._##TYPE##_value = *(TYPE*)rangeEnd;
 
 void *rtune_var_add_range(rtune_region_t *region, char *name, int total_num_states, rtune_data_type_t type, void *rangeBegin, void *rangeEnd, void *step) {
-    int i = region->num_vars;
-    rtune_var_t *var = &region->vars[i];
+    rtune_var_t *var = rtune_var_new(region);
+    if (var == NULL) return NULL;
     var->current_v_index = -1;
+    var->proposed_v_index = -1;
     var->kind = RTUNE_VAR_RANGE;
     var->status = RTUNE_STATUS_CREATED;
     //calculate the number of unique values, use the longest number (double) since they are all casted. This should work for short, int, float, long, double, etc.
@@ -173,26 +521,26 @@ void *rtune_var_add_range(rtune_region_t *region, char *name, int total_num_stat
     var->batch_size = DEFAULT_batch_size;
     var->update_iteration_stride = DEFAULT_update_iteration_stride;
     var->apply_policy = DEFAULT_VAR_apply_policy;
+    var->current_apply_index = -1;
 
     stvar_t *stvar = &var->stvar;
     stvar->name = name;
     stvar->type = type;
     stvar->num_states = 0;
     //allocate memory for both states and count_value array
-    var->count_value = (int*) malloc(sizeof(int) * var->num_unique_values);
+    var->count_value = (int*) rtune_arena_alloc(&region->arena, sizeof(int) * var->num_unique_values);
     stvar->total_num_states = total_num_states;
-    rtune_malloc_4_states(stvar);
+    rtune_malloc_4_states(region, stvar);
 
-    //no need to initialize other fields since they are memset as 0 when the region is initialized
+    //no need to initialize other fields since they are zeroed when the var is allocated
 
-    region->num_vars++;
     return (int *)var; //since this is the first field, it has the same address of the object itself (var or stvar)
 }
 
 
 void *rtune_var_add_ext(rtune_region_t *region, char *name, int total_num_states, rtune_data_type_t type, void *(*provider)(void *), void *provider_arg) {
-    int i = region->num_vars;
-    rtune_var_t *var = &region->vars[i];
+    rtune_var_t *var = rtune_var_new(region);
+    if (var == NULL) return NULL;
     var->num_unique_values = 0;
     var->kind = RTUNE_VAR_EXT;
     var->status = RTUNE_STATUS_CREATED;
@@ -203,41 +551,42 @@ void *rtune_var_add_ext(rtune_region_t *region, char *name, int total_num_states
     var->batch_size = DEFAULT_batch_size;
     var->update_iteration_stride = DEFAULT_update_iteration_stride;
     var->apply_policy = DEFAULT_VAR_apply_policy;
+    var->current_apply_index = -1;
 
     stvar_t *stvar = &var->stvar;
     stvar->provider = provider;
     stvar->provider_arg = provider_arg;
+    stvar->provider_kind = rtune_provider_kind_of(provider, provider_arg);
     stvar->name = name;
     stvar->type = type;
     stvar->num_states = 0;
     //allocate memory for both states and count_value array
     stvar->total_num_states = total_num_states;
-    rtune_malloc_4_states(stvar);
+    rtune_malloc_4_states(region, stvar);
 
-    //no need to initialize other fields since they are memset as 0 when the region is initialized
+    //no need to initialize other fields since they are zeroed when the var is allocated
 
-    region->num_vars++;
     return (int *)var; //since this is the first field, it has the same address of the object itself (var or stvar)
 }
 
 #if USING_VAR_EXT_DIFF_IS_USEFUL
 void *rtune_var_add_ext_diff(rtune_region_t *region, char *name, int total_num_states, rtune_data_type_t type, void *(*provider)(void *), void *provider_arg) {
-    int i = region->num_vars;
-    rtune_var_t *var = &region->vars[i];
+    rtune_var_t *var = rtune_var_new(region);
+    if (var == NULL) return NULL;
     var->kind = RTUNE_VAR_EXT_DIFF;
     stvar_t *stvar = &var->stvar;
     stvar->provider = provider;
     stvar->provider_arg = provider_arg;
+    stvar->provider_kind = rtune_provider_kind_of(provider, provider_arg);
     stvar->name = name;
     stvar->type = type;
     stvar->num_states = 0;
     //allocate memory for both states and count_value array
     stvar->total_num_states = total_num_states;
-    rtune_malloc_4_states(stvar);
+    rtune_malloc_4_states(region, stvar);
 
-    //no need to initialize other fields since they are memset as 0 when the region is initialized
+    //no need to initialize other fields since they are zeroed when the var is allocated
 
-    region->num_vars++;
     return (int *)var; //since this is the first field, it has the same address of the object itself (var or stvar)
 }
 #endif
@@ -250,10 +599,12 @@ void *rtune_var_add_ext_diff(rtune_region_t *region, char *name, int total_num_s
 void  rtune_var_set_applier_policy(rtune_var_t *var, void (*applier) (void *), rtune_var_apply_policy_t apply_policy) {
     var->stvar.applier = applier;
     var->apply_policy = apply_policy;
+    rtune_region_mark_dirty(var->region);
 }
 
 void  rtune_var_set_applier(rtune_var_t * var, void (*applier) (void *)) {
     var->stvar.applier = applier;
+    rtune_region_mark_dirty(var->region);
 }
 
 /**
@@ -264,6 +615,33 @@ void  rtune_var_set_applier(rtune_var_t * var, void (*applier) (void *)) {
  */
 void  rtune_var_set_apply_policy(rtune_var_t * var, rtune_var_apply_policy_t apply_policy) {
     var->apply_policy = apply_policy;
+    rtune_region_mark_dirty(var->region);
+}
+
+/**
+ * @brief set the reader that reads back the value in effect in the caller env, e.g. omp_get_max_threads for the applier
+ * omp_set_num_threads. With RTUNE_VAR_APPLY_ON_READ, the applier is called only if the value read back is not the one
+ * to apply. If the reader and reader_arg are the same, the reader is the address of the value
+ *
+ * @param var
+ * @param reader
+ * @param reader_arg
+ */
+void  rtune_var_set_apply_check(rtune_var_t * var, void *(*reader) (void *), void * reader_arg) {
+    var->apply_check.reader = reader;
+    var->apply_check.reader_arg = reader_arg;
+}
+
+/**
+ * @brief set the counter that is increased whenever the applied value is changed outside rtune. With RTUNE_VAR_APPLY_ON_READ
+ * and no reader, the applier is called only if the counter is increased since the value was applied. The counter is read
+ * before the applier is called, so the applier of the var must not increase it, otherwise the value is applied every time
+ *
+ * @param var
+ * @param generation
+ */
+void  rtune_var_set_apply_generation(rtune_var_t * var, const volatile unsigned long * generation) {
+    var->apply_check.generation = generation;
 }
 
 /**
@@ -334,6 +712,7 @@ void rtune_var_set_update_schedule_attr(rtune_var_t *var, rtune_var_update_kind_
     var->update_iteration_start = update_iteration_start;
     var->batch_size = batch_size;
     var->update_iteration_stride = update_iteration_stride;
+    rtune_region_mark_dirty(var->region);
 }
 
 void rtune_func_set_update_schedule_attr(rtune_func_t *func, rtune_var_update_kind_t update_lt,
@@ -343,6 +722,7 @@ void rtune_func_set_update_schedule_attr(rtune_func_t *func, rtune_var_update_ki
     func->update_iteration_start = update_iteration_start;
     func->batch_size = batch_size;
     func->update_iteration_stride = update_iteration_stride;
+    rtune_region_mark_dirty(func->region);
 }
 
 
@@ -374,63 +754,315 @@ int rtune_func_schedule_check(rtune_func_t * func) {
 }
 
 /**
- * @brief add a function that has known function operation to a region. The total number of states of the function is
- * calculated as the product of the total number of states of all input variables. This requires that the total number of
- * state is calculated/set before calling this function.
- * 
- * @param region 
- * @param func_kind 
- * @param name 
- * @param type the data type of the function
- * @param num_vars number of variables for this function
- * @param num_coefficient number of coefficient for this function
- * @param ... var and coefficient for the function, variables must be listed first and then coefficient.
- *            var should be listed in the order it is being enumerated and evaluated
- * @return void* the pointer to the rtune_func_t type
+ * allocate a func and its input arrays from the arena of the region and append it to the funcs of the region
+ * @return the zeroed func, or NULL if the system runs out of memory
  */
-void *rtune_func_add(rtune_region_t *region, rtune_kind_t kind, char *name, rtune_data_type_t type,
-                     int num_vars, int num_coefs, ...) {
-    int index = region->num_funcs;
-    rtune_func_t *func = &region->funcs[index];
+static rtune_func_t *rtune_func_new(rtune_region_t *region, int num_vars, int num_coefs) {
+    if (!RTUNE_ARRAY_RESERVE(&region->arena, region->funcs, region->num_funcs, region->max_funcs)) return NULL;
+    rtune_func_t *func = (rtune_func_t *) rtune_arena_alloc(&region->arena, sizeof(rtune_func_t));
+    if (func == NULL) return NULL;
+    func->input_vars = (rtune_var_t **) rtune_arena_alloc(&region->arena, sizeof(rtune_var_t *) * (num_vars + 1));
+    func->input_coefs = (utype_t *) rtune_arena_alloc(&region->arena, sizeof(utype_t) * (num_coefs + 1));
+    if (func->input_vars == NULL || func->input_coefs == NULL) return NULL;
+    func->region = region;
+    func->topo_index = -1;
+    region->funcs[region->num_funcs++] = func;
+    rtune_region_mark_dirty(region);
+    return func;
+}
+
+/**
+ * grow the states of the func and the columns of its sample store, by doubling up to the total number of states of the
+ * func, the rows that have been recorded are copied.
+ * @return 0 on success, -1 if the system runs out of memory
+ */
+static int rtune_func_samples_grow(rtune_func_t *func) {
+    stvar_t *stvar = &func->stvar;
+    rtune_samples_t *samples = &func->samples;
+    rtune_arena_t *arena = &func->region->arena;
+    int capacity = samples->capacity == 0 ? DEFAULT_FUNC_SAMPLE_CAPACITY : samples->capacity * 2;
+    if (capacity > stvar->total_num_states) capacity = stvar->total_num_states;
+    int num_rows = stvar->num_states;
+    int j;
+
+    void *states = rtune_arena_alloc(arena, stvar->ops->size * capacity);
+    int *iteration = (int *) rtune_arena_alloc(arena, sizeof(int) * capacity);
+    if (states == NULL || iteration == NULL) return -1;
+    if (samples->var_index == NULL) {
+        samples->var_index = (int **) rtune_arena_alloc(arena, sizeof(int *) * (func->num_vars + 1));
+        samples->var_value = (void **) rtune_arena_alloc(arena, sizeof(void *) * (func->num_vars + 1));
+        if (samples->var_index == NULL || samples->var_value == NULL) return -1;
+    }
+    for (j = 0; j < func->num_vars; j++) {
+        size_t size = func->input_vars[j]->stvar.ops->size;
+        int *var_index = (int *) rtune_arena_alloc(arena, sizeof(int) * capacity);
+        void *var_value = rtune_arena_alloc(arena, size * capacity);
+        if (var_index == NULL || var_value == NULL) return -1;
+        if (num_rows > 0) {
+            memcpy(var_index, samples->var_index[j], sizeof(int) * num_rows);
+            memcpy(var_value, samples->var_value[j], size * num_rows);
+        }
+        samples->var_index[j] = var_index;
+        samples->var_value[j] = var_value;
+    }
+    if (stvar->dispersion != NULL) {
+        double *dispersion = (double *) rtune_arena_alloc(arena, sizeof(double) * capacity);
+        if (dispersion == NULL) return -1;
+        if (num_rows > 0) memcpy(dispersion, stvar->dispersion, sizeof(double) * num_rows);
+        stvar->dispersion = dispersion;
+    }
+    if (num_rows > 0) {
+        memcpy(states, stvar->states, stvar->ops->size * num_rows);
+        memcpy(iteration, samples->iteration, sizeof(int) * num_rows);
+    }
+    stvar->states = states;
+    samples->iteration = iteration;
+    samples->capacity = capacity;
+    return 0;
+}
+
+rtune_column_t rtune_func_column_value(rtune_func_t * func) {
+    rtune_column_t column = {func->stvar.states, func->stvar.type, func->stvar.num_states};
+    return column;
+}
+
+rtune_column_t rtune_func_column_iteration(rtune_func_t * func) {
+    rtune_column_t column = {func->samples.iteration, RTUNE_int, func->stvar.num_states};
+    return column;
+}
+
+/**
+ * @brief the values of the var-th input var of the func for each sample of the func
+ */
+rtune_column_t rtune_func_column_var(rtune_func_t * func, int var) {
+    rtune_column_t column = {func->samples.var_value[var], func->input_vars[var]->stvar.type, func->stvar.num_states};
+    return column;
+}
+
+/**
+ * @brief the index of the state of the var-th input var of the func for each sample of the func
+ */
+rtune_column_t rtune_func_column_var_index(rtune_func_t * func, int var) {
+    rtune_column_t column = {func->samples.var_index[var], RTUNE_int, func->stvar.num_states};
+    return column;
+}
+
+/**
+ * the i-th value of a column as double
+ */
+static double rtune_column_double(rtune_column_t column, int i) {
+    switch (column.type) {
+        case RTUNE_short: return RTUNE_COLUMN_VALUE(short, column, i);
+        case RTUNE_int: return RTUNE_COLUMN_VALUE(int, column, i);
+        case RTUNE_long: return RTUNE_COLUMN_VALUE(long, column, i);
+        case RTUNE_float: return RTUNE_COLUMN_VALUE(float, column, i);
+        case RTUNE_double: return RTUNE_COLUMN_VALUE(double, column, i);
+        default: return 0.0;
+    }
+}
+
+/**
+ * the v-th value of a list or range var as double
+ */
+static double rtune_var_value_double(rtune_var_t *var, int v) {
+    if (var->kind == RTUNE_VAR_LIST) {
+        rtune_column_t values = {var->list_range_setting.list.list_values, var->stvar.type, var->num_unique_values};
+        return rtune_column_double(values, v);
+    }
+    const rtune_stvar_ops_t *ops = var->stvar.ops;
+    return ops->to_double(var->list_range_setting.range.rangeBegin) + v * ops->to_double(var->list_range_setting.range.step);
+}
+
+/**
+ * the index of the value of a list or range var that is nearest to x, e.g. to map a sampled value back to the list/range
+ */
+static int rtune_var_value_index(rtune_var_t *var, double x) {
+    int v;
+    int nearest = 0;
+    if (var->kind == RTUNE_VAR_RANGE) {
+        const rtune_stvar_ops_t *ops = var->stvar.ops;
+        double step = ops->to_double(var->list_range_setting.range.step);
+        nearest = step != 0.0 ? (int) lround((x - ops->to_double(var->list_range_setting.range.rangeBegin)) / step) : 0;
+        if (nearest < 0) nearest = 0;
+        if (nearest >= var->num_unique_values) nearest = var->num_unique_values - 1;
+        return nearest;
+    }
+    for (v = 1; v < var->num_unique_values; v++) {
+        if (fabs(rtune_var_value_double(var, v) - x) < fabs(rtune_var_value_double(var, nearest) - x)) nearest = v;
+    }
+    return nearest;
+}
+
+/**
+ * the min and the max of the values of a list or range var
+ */
+static void rtune_var_value_bounds(rtune_var_t *var, double *lo, double *hi) {
+    int v;
+    *lo = *hi = rtune_var_value_double(var, 0);
+    for (v = 1; v < var->num_unique_values; v++) {
+        double value = rtune_var_value_double(var, v);
+        if (value < *lo) *lo = value;
+        if (value > *hi) *hi = value;
+    }
+}
+
+/**
+ * set the link from the var to the func that uses it as input
+ */
+static void rtune_var_link_func(rtune_var_t *var, rtune_func_t *func) {
+    if (!RTUNE_ARRAY_RESERVE(&var->region->arena, var->usedByFuncs, var->num_uses, var->max_uses)) return;
+    var->usedByFuncs[var->num_uses++] = func;
+}
+
+/**
+ * set the link from the func to the derived func that uses it as input
+ */
+static void rtune_func_link_func(rtune_func_t *func, rtune_func_t *derived) {
+    if (!RTUNE_ARRAY_RESERVE(&func->region->arena, func->usedByFuncs, func->num_uses, func->max_uses)) return;
+    func->usedByFuncs[func->num_uses++] = derived;
+}
+
+/**
+ * whether the func is derived from other vars/funcs by the evaluation engine (see rtune_func_derive) instead of being
+ * scheduled to read a provider
+ */
+static inline int rtune_func_is_derived(rtune_func_t *func) {
+    return func->kind >= RTUNE_FUNC_LOG && func->kind <= RTUNE_FUNC_PRODUCT;
+}
+
+/**
+ * whether the input is a func of the region, otherwise it is a var
+ */
+static int rtune_region_has_func(rtune_region_t *region, void *input) {
+    int i;
+    for (i = 0; i < region->num_funcs; i++) {
+        if (region->funcs[i] == input) return 1;
+    }
+    return 0;
+}
+
+/**
+ * Add a derived func of the operands, each is either a var or a func. The input vars of the func are the var operands
+ * and the input vars of the func operands, so each sample of the func records the config it is derived under. The
+ * func is updated with each new state of its func operands (of all of them if there are more than one), or with each
+ * new state of its var operands if it has no func operand, see rtune_func_derive.
+ * @param coefs pointers to values of the type of the first operand
+ * @return the func, or NULL if the system runs out of memory
+ */
+static rtune_func_t *rtune_func_add_derived(rtune_region_t *region, rtune_kind_t kind, char *name, rtune_data_type_t type,
+                                            int num_operands, void **operands, int num_coefs, void **coefs) {
+    int i, j, k;
+    int max_vars = 0;
+    int num_input_funcs = 0;
+    int is_func[num_operands + 1];
+    for (i = 0; i < num_operands; i++) {
+        is_func[i] = rtune_region_has_func(region, operands[i]);
+        max_vars += is_func[i] ? ((rtune_func_t *) operands[i])->num_vars : 1;
+        num_input_funcs += is_func[i];
+    }
+    rtune_var_t *vars[max_vars + 1];
+    int num_vars = 0;
+    for (i = 0; i < num_operands; i++) {
+        rtune_var_t **operand_vars = is_func[i] ? ((rtune_func_t *) operands[i])->input_vars : (rtune_var_t **) &operands[i];
+        int num_operand_vars = is_func[i] ? ((rtune_func_t *) operands[i])->num_vars : 1;
+        for (j = 0; j < num_operand_vars; j++) {
+            for (k = 0; k < num_vars && vars[k] != operand_vars[j]; k++);
+            if (k == num_vars) vars[num_vars++] = operand_vars[j];
+        }
+    }
+
+    rtune_func_t *func = rtune_func_new(region, num_vars, num_coefs);
+    if (func == NULL) return NULL;
+    func->operands = (stvar_t **) rtune_arena_alloc(&region->arena, sizeof(stvar_t *) * num_operands);
+    func->operand_columns = (int *) rtune_arena_alloc(&region->arena, sizeof(int) * num_operands);
+    func->input_funcs = (rtune_func_t **) rtune_arena_alloc(&region->arena, sizeof(rtune_func_t *) * (num_input_funcs + 1));
+    if (func->operands == NULL || func->operand_columns == NULL || func->input_funcs == NULL) return NULL;
 
     stvar_t *stvar = &func->stvar;
     stvar->name = name;
     stvar->type = type;
     func->kind = kind;
     func->status = RTUNE_STATUS_CREATED;
+    func->update_lt = RTUNE_DEFAULT_NONE;
+    func->update_policy = RTUNE_DEFAULT_NONE;
     func->num_vars = num_vars;
+    for (i = 0; i < num_vars; i++) func->input_vars[i] = vars[i];
+    int total_num_states = 1;
+    for (i = 0; i < num_operands; i++) {
+        func->operands[i] = (stvar_t *) operands[i];
+        if (is_func[i]) {
+            rtune_func_t *input = (rtune_func_t *) operands[i];
+            if (func->num_input_funcs == 0) {
+                total_num_states = input->stvar.total_num_states;
+                stvar->trace_mode = input->stvar.trace_mode;
+            }
+            func->input_funcs[func->num_input_funcs++] = input;
+            rtune_func_link_func(input, func);
+        } else {
+            rtune_var_t *var = (rtune_var_t *) operands[i];
+            if (num_input_funcs == 0) total_num_states *= var->stvar.total_num_states;
+            rtune_var_link_func(var, func);
+        }
+    }
+    func->num_operands = num_operands;
+    //resolve where each operand is read from once, a var operand is read from the samples of the first func operand if
+    //it is an input var of it, see rtune_func_derive
+    rtune_func_t *source = func->num_input_funcs > 0 ? func->input_funcs[0] : NULL;
+    for (i = 0; i < num_operands; i++) {
+        func->operand_columns[i] = is_func[i] ? RTUNE_OPERAND_FUNC : RTUNE_OPERAND_VALUE;
+        if (source != NULL && !is_func[i]) {
+            for (k = 0; k < source->num_vars; k++) {
+                if (source->input_vars[k] == (rtune_var_t *) operands[i]) func->operand_columns[i] = k;
+            }
+        }
+    }
     func->num_coefs = num_coefs;
+    for (i = 0; i < num_coefs; i++) func->input_coefs[i] = func->operands[0]->ops->read(coefs[i], coefs[i]);
 
-    //set the default update time/policy/iteration_start/batch/stride
-    func->update_lt = DEFAULT_FUNC_update_lt;
-    func->update_policy = DEFAULT_update_policy;
-    func->update_iteration_start = DEFAULT_update_iteration_start;
-    func->batch_size = DEFAULT_batch_size;
-    func->update_iteration_stride = DEFAULT_update_iteration_stride;
+    stvar->total_num_states = total_num_states;
+    stvar->ops = rtune_stvar_ops_of(type);
+    stvar->stats.ewma_alpha = DEFAULT_EWMA_alpha;
+    if (rtune_func_samples_grow(func) != 0) return NULL;
+    return func;
+}
 
-    func->unused_updates = 0;
+/**
+ * Add the parallel efficiency func work/(exe_time*num_threads) of a region, i.e. the throughput per thread. It is a derived
+ * func that is updated with each new state of exe_time, from the values of num_threads and work at that time, so it has
+ * as many states as exe_time.
+ * @param work the var of the work size of the region, NULL if the work is fixed, in which case it is 1
+ */
+rtune_func_t* rtune_func_add_efficiency(rtune_region_t * region, char * name, rtune_func_t * exe_time, rtune_var_t * num_threads, rtune_var_t * work) {
+    void *operands[3] = {exe_time, num_threads, work};
+    return rtune_func_add_derived(region, RTUNE_FUNC_EFFICIENCY, name, RTUNE_double, work != NULL ? 3 : 2, operands, 0, NULL);
+}
 
+/**
+ * @brief add a function that has known function operation to a region, see rtune_func_add_derived. The func is derived
+ * from its inputs by the evaluation engine, and is not scheduled by itself.
+ * 
+ * @param region 
+ * @param func_kind one of RTUNE_FUNC_LOG to RTUNE_FUNC_PRODUCT
+ * @param name 
+ * @param type the data type of the function
+ * @param num_vars number of inputs (vars or funcs) for this function
+ * @param num_coefficient number of coefficient for this function
+ * @param ... inputs and coefficients for the function, inputs must be listed first in the order of the operation, and
+ *            then the coefficients as pointers to values of the type of the first input
+ * @return void* the pointer to the rtune_func_t type
+ */
+void *rtune_func_add(rtune_region_t *region, rtune_kind_t kind, char *name, rtune_data_type_t type,
+                     int num_vars, int num_coefs, ...) {
+    void *operands[num_vars + 1];
+    void *coefs[num_coefs + 1];
     int i;
     va_list args;
     va_start(args, num_coefs);
-    int total_num_states = 1;
-    for (i = 0; i < num_vars; i++) {
-        rtune_var_t *var = va_arg(args, rtune_var_t *);
-        var->usedByFuncs[var->num_uses++] = func; //set the var dependency link
-        total_num_states *= var->stvar.total_num_states; //The number of states of the func is the products of the states of all input vars
-        func->input_vars[i] = var;
-    }
-    for (i=0; i < num_coefs; i++) {
-        func->input_coefs[i] = (utype_t) va_arg(args, utype_t);
-    }
+    for (i = 0; i < num_vars; i++) operands[i] = va_arg(args, void *);
+    for (i = 0; i < num_coefs; i++) coefs[i] = va_arg(args, void *);
     va_end(args);
-    stvar->total_num_states = total_num_states;
-    rtune_func_schedule_check(func);
-    rtune_malloc_4_states(stvar); //allocate memory for storing states
-    //allocate memory for storing input of variables, which are represented by the index of the state of the variable
-    func->input = (int*) malloc(sizeof(int) * total_num_states * num_vars);
-    region->num_funcs++;
-    return func;
+    if (kind < RTUNE_FUNC_LOG || kind > RTUNE_FUNC_PRODUCT || kind == RTUNE_FUNC_EFFICIENCY || num_vars <= 0) return NULL;
+    return rtune_func_add_derived(region, kind, name, type, num_vars, operands, num_coefs, coefs);
 }
 
 /**
@@ -449,8 +1081,8 @@ void *rtune_func_add(rtune_region_t *region, rtune_kind_t kind, char *name, rtun
  */
 rtune_func_t* rtune_func_add_model(rtune_region_t * region, rtune_kind_t kind, char * name, rtune_data_type_t type,
                            void *(*provider) (void *), void * provider_arg, int num_vars, ...) {
-    int index = region->num_funcs;
-    rtune_func_t *func = &region->funcs[index];
+    rtune_func_t *func = rtune_func_new(region, num_vars, 0);
+    if (func == NULL) return NULL;
 
     stvar_t *stvar = &func->stvar;
     stvar->name = name;
@@ -459,6 +1091,7 @@ rtune_func_t* rtune_func_add_model(rtune_region_t * region, rtune_kind_t kind, c
     func->status = RTUNE_STATUS_CREATED;
     stvar->provider = provider;
     stvar->provider_arg = provider_arg;
+    stvar->provider_kind = rtune_provider_kind_of(provider, provider_arg);
     func->num_vars = num_vars;
     func->num_coefs = 0;
 
@@ -476,20 +1109,38 @@ rtune_func_t* rtune_func_add_model(rtune_region_t * region, rtune_kind_t kind, c
     int total_num_states = 1;
     for (i = 0; i < num_vars; i++) {
         rtune_var_t *var = va_arg(args, rtune_var_t *);
-        var->usedByFuncs[var->num_uses++] = func; //set the var dependency link
+        rtune_var_link_func(var, func); //set the var dependency link
         total_num_states *= var->stvar.total_num_states; //The number of states of the func is the products of the states of all input vars
         func->input_vars[i] = var;
     }
     va_end(args);
     stvar->total_num_states = total_num_states;
     rtune_func_schedule_check(func);
-    rtune_malloc_4_states(stvar); //allocate memory for storing states
-    //allocate memory for storing input of variables, which are represented by the index of the state of the variable
-    func->input = (int*) malloc(sizeof(int) * total_num_states * num_vars);
-    region->num_funcs++;
+    stvar->ops = rtune_stvar_ops_of(type);
+    stvar->stats.ewma_alpha = DEFAULT_EWMA_alpha;
+    if (rtune_func_samples_grow(func) != 0) return NULL; //allocate the states and the sample columns for the first samples
     return func;
 }
 
+/**
+ * fit a model of the func over its first input var with each new sample of the func from now on
+ * @return 0 on success, -1 if the kind is not a supported model or the system runs out of memory
+ */
+int rtune_func_set_model(rtune_func_t * func, rtune_kind_t model_kind) {
+    if (func->num_vars == 0) return -1;
+    rtune_model_t *model = func->model;
+    if (model == NULL) model = (rtune_model_t *) rtune_arena_alloc(&func->region->arena, sizeof(rtune_model_t));
+    if (model == NULL || rtune_model_init(model, model_kind) != 0) return -1;
+    rtune_var_t *var = func->input_vars[0];
+    if (var->kind == RTUNE_VAR_LIST || var->kind == RTUNE_VAR_RANGE) {
+        double lo, hi;
+        rtune_var_value_bounds(var, &lo, &hi);
+        rtune_model_set_domain(model, lo, hi);
+    }
+    func->model = model;
+    return 0;
+}
+
 void *rtune_func_add_log(rtune_region_t *region, char *name, rtune_data_type_t type, void *var) {
     return rtune_func_add(region, RTUNE_FUNC_LOG, name, type, 1, 0, var);
 }
@@ -511,9 +1162,24 @@ void *rtune_func_add_gradient(rtune_region_t *region, char *name, rtune_data_typ
     return rtune_func_add(region, RTUNE_FUNC_GRADIENT, name, type, 1, 0, var);
 }
 
-void set_max(utype_t * v, rtune_data_type_t type) {
-    switch (type) {
-        case RTUNE_short:
+/* This variable is the diff var1 - var2 */
+void *rtune_func_add_diff(rtune_region_t *region, char *name, rtune_data_type_t type, void *var1, void *var2) {
+    return rtune_func_add(region, RTUNE_FUNC_DIFF, name, type, 2, 0, var1, var2);
+}
+
+/* This variable is numerator / denominator, e.g. the work per second, 0 if the denominator is 0 */
+void *rtune_func_add_ratio(rtune_region_t *region, char *name, rtune_data_type_t type, void *numerator, void *denominator) {
+    return rtune_func_add(region, RTUNE_FUNC_RATIO, name, type, 2, 0, numerator, denominator);
+}
+
+/* This variable is var1 * var2, e.g. energy x time */
+void *rtune_func_add_product(rtune_region_t *region, char *name, rtune_data_type_t type, void *var1, void *var2) {
+    return rtune_func_add(region, RTUNE_FUNC_PRODUCT, name, type, 2, 0, var1, var2);
+}
+
+void set_max(utype_t * v, rtune_data_type_t type) {
+    switch (type) {
+        case RTUNE_short:
             v->_short_value = SHRT_MAX; break;
         case RTUNE_int:
             v->_int_value = INT_MAX; break;
@@ -538,9 +1204,9 @@ void set_min(utype_t * v, rtune_data_type_t type) {
         case RTUNE_long:
             v->_long_value = LONG_MIN; break;
         case RTUNE_float:
-            v->_float_value = FLT_MIN; break;
+            v->_float_value = -FLT_MAX; break;
         case RTUNE_double:
-            v->_double_value = DBL_MIN; break;
+            v->_double_value = -DBL_MAX; break;
         default:
             //error
             break;
@@ -550,10 +1216,15 @@ void set_min(utype_t * v, rtune_data_type_t type) {
 /**
  * collect all the independent var of the functions of the obj so they can be used easier later on
  * @param obj
+ * @return the number of vars, -1 if the system runs out of memory
  */
 static int rtune_objective_collect_vars(rtune_objective_t * obj) {
     int i;
-    int usage_count[MAX_NUM_VARS] = {0};
+    int max_vars = 0;
+    for (i=0; i<obj->num_funcs; i++) max_vars += obj->input_funcs[i].func->num_vars;
+    obj->input_vars = (struct input_var *) rtune_arena_alloc(&obj->region->arena, sizeof(struct input_var) * (max_vars + 1));
+    if (obj->input_vars == NULL) return -1;
+    int usage_count[max_vars + 1];
     int num_vars = 0;
     for (i=0; i<obj->num_funcs; i++) {
         rtune_func_t *func = obj->input_funcs[i].func;
@@ -581,12 +1252,27 @@ static int rtune_objective_collect_vars(rtune_objective_t * obj) {
     return num_vars;
 }
 
-rtune_objective_t *rtune_objective_add_min(rtune_region_t *region, char *name, rtune_func_t *func) {
-    int i = region->num_objs;
-    rtune_objective_t *obj = &region->objs[i];
+/**
+ * allocate an objective from the arena of the region with the default attributes and append it to the objs of the region
+ * @return the objective, or NULL if the system runs out of memory
+ */
+static rtune_objective_t *rtune_objective_new(rtune_region_t *region, char *name, int num_funcs, int num_coefs) {
+    int max_objs = region->max_objs;
+    if (!RTUNE_ARRAY_RESERVE(&region->arena, region->objs, region->num_objs, region->max_objs)) return NULL;
+    if (region->max_objs != max_objs) { //objs just grew, due_objs needs to hold all of them
+        rtune_objective_t **due_objs = (rtune_objective_t **) rtune_arena_alloc(&region->arena, sizeof(rtune_objective_t *) * region->max_objs);
+        if (due_objs == NULL) return NULL;
+        if (region->num_due_objs > 0) memcpy(due_objs, region->due_objs, sizeof(rtune_objective_t *) * region->num_due_objs);
+        region->due_objs = due_objs;
+    }
+    rtune_objective_t *obj = (rtune_objective_t *) rtune_arena_alloc(&region->arena, sizeof(rtune_objective_t));
+    if (obj == NULL) return NULL;
+    obj->input_funcs = (struct input_funcs *) rtune_arena_alloc(&region->arena, sizeof(struct input_funcs) * (num_funcs + 1));
+    obj->input_coefs = (struct input_coefs *) rtune_arena_alloc(&region->arena, sizeof(struct input_coefs) * (num_coefs + 1));
+    if (obj->input_funcs == NULL || obj->input_coefs == NULL) return NULL;
+    obj->region = region;
     obj->name = name;
     obj->status = RTUNE_STATUS_CREATED;
-    region->num_objs++;
     obj->deviation_tolerance = DEFAULT_deviation_tolerance;
     obj->fidelity_window = DEFAULT_fidelity_window;
     obj->lookup_window = DEFAULT_lookup_window;
@@ -594,61 +1280,71 @@ rtune_objective_t *rtune_objective_add_min(rtune_region_t *region, char *name, r
     obj->max_num_mets = 1;
     obj->num_mets = 0;
     obj->metaction = RTUNE_METACTION_NOACTION;
+    region->objs[region->num_objs++] = obj;
+    return obj;
+}
+
+/**
+ * drop an objective that cannot be set up, which is the last objective of its region and of each of its funcs
+ * @return NULL for the constructor of the objective to return
+ */
+static rtune_objective_t *rtune_objective_discard(rtune_objective_t *obj) {
+    rtune_region_t *region = obj->region;
+    int i;
+    if (region->num_objs > 0 && region->objs[region->num_objs - 1] == obj) region->num_objs--;
+    for (i = 0; i < obj->num_funcs; i++) {
+        rtune_func_t *func = obj->input_funcs[i].func;
+        if (func->num_objs > 0 && func->objectives[func->num_objs - 1] == obj) func->num_objs--;
+    }
+    return NULL;
+}
 
+/**
+ * set the link from the func to the objective that uses it
+ */
+static void rtune_func_link_objective(rtune_func_t *func, rtune_objective_t *obj) {
+    if (!RTUNE_ARRAY_RESERVE(&func->region->arena, func->objectives, func->num_objs, func->max_objs)) return;
     func->objectives[func->num_objs++] = obj;
+}
+
+rtune_objective_t *rtune_objective_add_min(rtune_region_t *region, char *name, rtune_func_t *func) {
+    rtune_objective_t *obj = rtune_objective_new(region, name, 1, 0);
+    if (obj == NULL) return NULL;
+
+    rtune_func_link_objective(func, obj);
 
     obj->num_funcs = 1;
     obj->input_funcs[0].func = func;
     obj->input_funcs[0].metaction = RTUNE_METACTION_NOACTION;
 
     obj->kind = RTUNE_OBJECTIVE_MIN;
-    rtune_objective_collect_vars(obj);
+    if (rtune_objective_collect_vars(obj) < 0) return rtune_objective_discard(obj);
     set_max(&(obj->input_funcs[0].value), func->stvar.type); obj->input_vars[0].index = -1;
     return obj;
 }
 
 rtune_objective_t *rtune_objective_add_max(rtune_region_t *region, char *name, rtune_func_t *func) {
-    int i = region->num_objs;
-    rtune_objective_t *obj = &region->objs[i];
-    obj->name = name;
-    obj->status = RTUNE_STATUS_CREATED;
-    region->num_objs++;
-    obj->deviation_tolerance = DEFAULT_deviation_tolerance;
-    obj->fidelity_window = DEFAULT_fidelity_window;
-    obj->lookup_window = DEFAULT_lookup_window;
-    obj->search_strategy = RTUNE_OBJECTIVE_SEARCH_DEFAULT;
-    obj->max_num_mets = 1;
-    obj->num_mets = 0;
-    obj->metaction = RTUNE_METACTION_NOACTION;
+    rtune_objective_t *obj = rtune_objective_new(region, name, 1, 0);
+    if (obj == NULL) return NULL;
 
-    func->objectives[func->num_objs++] = obj;
+    rtune_func_link_objective(func, obj);
 
     obj->num_funcs = 1;
     obj->input_funcs[0].func = func;
     obj->input_funcs[0].metaction = RTUNE_METACTION_NOACTION;
 
     obj->kind = RTUNE_OBJECTIVE_MAX;
-    rtune_objective_collect_vars(obj);
+    if (rtune_objective_collect_vars(obj) < 0) return rtune_objective_discard(obj);
     set_min(&(obj->input_funcs[0].value), func->stvar.type); obj->input_vars[0].index = -1;
     return obj;
 }
 
 rtune_objective_t *rtune_objective_add_intersection(rtune_region_t *region, char *name, rtune_func_t *model1, rtune_func_t *model2) {
-    int i = region->num_objs;
-    rtune_objective_t *obj = &region->objs[i];
-    obj->name = name;
-    obj->status = RTUNE_STATUS_CREATED;
-    region->num_objs++;
-    obj->deviation_tolerance = DEFAULT_deviation_tolerance;
-    obj->fidelity_window = DEFAULT_fidelity_window;
-    obj->lookup_window = DEFAULT_lookup_window;
-    obj->search_strategy = RTUNE_OBJECTIVE_SEARCH_DEFAULT;
-    obj->max_num_mets = 1;
-    obj->num_mets = 0;
-    obj->metaction = RTUNE_METACTION_NOACTION;
+    rtune_objective_t *obj = rtune_objective_new(region, name, 2, 0);
+    if (obj == NULL) return NULL;
 
-    model1->objectives[model1->num_objs++] = obj;
-    model2->objectives[model2->num_objs++] = obj;
+    rtune_func_link_objective(model1, obj);
+    rtune_func_link_objective(model2, obj);
 
     obj->num_funcs = 2;
     obj->input_funcs[0].func = model1;
@@ -657,7 +1353,7 @@ rtune_objective_t *rtune_objective_add_intersection(rtune_region_t *region, char
     obj->input_funcs[1].metaction = RTUNE_METACTION_NOACTION;
 
     obj->kind = RTUNE_OBJECTIVE_INTERSECTION;
-    rtune_objective_collect_vars(obj);
+    if (rtune_objective_collect_vars(obj) < 0) return rtune_objective_discard(obj);
     return obj;
 }
 
@@ -666,21 +1362,11 @@ rtune_objective_t *rtune_objective_add_intersection(rtune_region_t *region, char
  */
 rtune_objective_t *rtune_objective_add_select2(rtune_region_t *region, char *name, rtune_objective_kind_t select_kind, rtune_func_t *model1, rtune_func_t *model2, int *model1_select, int *model2_select) {
     if (select_kind != RTUNE_OBJECTIVE_SELECT_MIN && select_kind != RTUNE_OBJECTIVE_SEELCT_MAX) return NULL;
-    int i = region->num_objs;
-    rtune_objective_t *obj = &region->objs[i];
-    obj->name = name;
-    obj->status = RTUNE_STATUS_CREATED;
-    region->num_objs++;
-    obj->deviation_tolerance = DEFAULT_deviation_tolerance;
-    obj->fidelity_window = DEFAULT_fidelity_window;
-    obj->lookup_window = DEFAULT_lookup_window;
-    obj->search_strategy = RTUNE_OBJECTIVE_SEARCH_DEFAULT;
-    obj->max_num_mets = 1;
-    obj->num_mets = 0;
-    obj->metaction = RTUNE_METACTION_NOACTION;
+    rtune_objective_t *obj = rtune_objective_new(region, name, 2, 0);
+    if (obj == NULL) return NULL;
 
-    model1->objectives[model1->num_objs++] = obj;
-    model2->objectives[model2->num_objs++] = obj;
+    rtune_func_link_objective(model1, obj);
+    rtune_func_link_objective(model2, obj);
 
     obj->num_funcs = 2;
     obj->input_funcs[0].func = model1;
@@ -692,7 +1378,7 @@ rtune_objective_t *rtune_objective_add_select2(rtune_region_t *region, char *nam
     //obj->input_funcoefs[4] = model2_select;
 
     obj->kind = select_kind;
-    rtune_objective_collect_vars(obj);
+    if (rtune_objective_collect_vars(obj) < 0) return rtune_objective_discard(obj);
     return obj;
 }
 
@@ -701,22 +1387,15 @@ rtune_objective_t *rtune_objective_add_select2(rtune_region_t *region, char *nam
  */
 rtune_objective_t *rtune_objective_add_select(rtune_region_t *region, char *name, rtune_objective_kind_t select_kind, int num_models, rtune_func_t *models[], int model_select[]) {
     if (select_kind != RTUNE_OBJECTIVE_SELECT_MIN && select_kind != RTUNE_OBJECTIVE_SEELCT_MAX) return NULL;
-    int i = region->num_objs;
-    rtune_objective_t *obj = &region->objs[i];
-    obj->name = name;
-    obj->status = RTUNE_STATUS_CREATED;
-    region->num_objs++;
-    obj->deviation_tolerance = DEFAULT_deviation_tolerance;
-    obj->fidelity_window = DEFAULT_fidelity_window;
-    obj->lookup_window = DEFAULT_lookup_window;
-    obj->search_strategy = RTUNE_OBJECTIVE_SEARCH_DEFAULT;
-    obj->max_num_mets = 1;
-    obj->num_mets = 0;
-    obj->metaction = RTUNE_METACTION_NOACTION;
+    rtune_objective_t *obj = rtune_objective_new(region, name, num_models, 0);
+    if (obj == NULL) return NULL;
 
+    int i;
     for (i=0; i<num_models;i++) {
         rtune_func_t * tmp = models[i];
-        tmp->objectives[tmp->num_objs++] = obj;
+        rtune_func_link_objective(tmp, obj);
+        obj->input_funcs[i].func = tmp;
+        obj->input_funcs[i].metaction = RTUNE_METACTION_NOACTION;
     }
 
     obj->num_funcs = num_models;
@@ -728,7 +1407,7 @@ rtune_objective_t *rtune_objective_add_select(rtune_region_t *region, char *name
     //obj->input_funcoefs[2] = model_select; //a mask to show which model is selected
 
     obj->kind = select_kind;
-    rtune_objective_collect_vars(obj);
+    if (rtune_objective_collect_vars(obj) < 0) return rtune_objective_discard(obj);
     return obj;
 }
 
@@ -737,20 +1416,10 @@ rtune_objective_t *rtune_objective_add_threshold(rtune_region_t *region, char *n
     if (threshold_kind != RTUNE_OBJECTIVE_THRESHOLD && threshold_kind != RTUNE_OBJECTIVE_THRESHOLD_UP && threshold_kind != RTUNE_OBJECTIVE_THRESHOLD_DOWN)
         return NULL;
 
-    int i = region->num_objs;
-    rtune_objective_t *obj = &region->objs[i];
-    obj->name = name;
-    obj->status = RTUNE_STATUS_CREATED;
-    region->num_objs++;
-    obj->deviation_tolerance = DEFAULT_deviation_tolerance;
-    obj->fidelity_window = DEFAULT_fidelity_window;
-    obj->lookup_window = DEFAULT_lookup_window;
-    obj->search_strategy = RTUNE_OBJECTIVE_SEARCH_DEFAULT;
-    obj->max_num_mets = 1;
-    obj->num_mets = 0;
-    obj->metaction = RTUNE_METACTION_NOACTION;
+    rtune_objective_t *obj = rtune_objective_new(region, name, 1, 1);
+    if (obj == NULL) return NULL;
 
-    model->objectives[model->num_objs++] = obj;
+    rtune_func_link_objective(model, obj);
 
     obj->num_funcs = 1;
     obj->input_funcs[0].func = model;
@@ -759,26 +1428,16 @@ rtune_objective_t *rtune_objective_add_threshold(rtune_region_t *region, char *n
     obj->input_coefs[0].coef = (utype_t)threshold;
 
     obj->kind = threshold_kind;
-    rtune_objective_collect_vars(obj);
+    if (rtune_objective_collect_vars(obj) < 0) return rtune_objective_discard(obj);
     return obj;
 }
 
 //going down to reach a threshold
 rtune_objective_t *rtune_objective_add_threshold_down(rtune_region_t *region, char *name, rtune_func_t *model, void *threshold) {
-    int i = region->num_objs;
-    rtune_objective_t *obj = &region->objs[i];
-    obj->name = name;
-    obj->status = RTUNE_STATUS_CREATED;
-    region->num_objs++;
-    obj->deviation_tolerance = DEFAULT_deviation_tolerance;
-    obj->fidelity_window = DEFAULT_fidelity_window;
-    obj->lookup_window = DEFAULT_lookup_window;
-    obj->search_strategy = RTUNE_OBJECTIVE_SEARCH_DEFAULT;
-    obj->max_num_mets = 1;
-    obj->num_mets = 0;
-    obj->metaction = RTUNE_METACTION_NOACTION;
+    rtune_objective_t *obj = rtune_objective_new(region, name, 1, 1);
+    if (obj == NULL) return NULL;
 
-    model->objectives[model->num_objs++] = obj;
+    rtune_func_link_objective(model, obj);
 
     obj->num_funcs = 1;
     obj->input_funcs[0].func = model;
@@ -787,7 +1446,7 @@ rtune_objective_t *rtune_objective_add_threshold_down(rtune_region_t *region, ch
     obj->input_coefs[0].coef = (utype_t)threshold;
 
     obj->kind = RTUNE_OBJECTIVE_THRESHOLD_DOWN;
-    rtune_objective_collect_vars(obj);
+    if (rtune_objective_collect_vars(obj) < 0) return rtune_objective_discard(obj);
     return obj;
 }
 
@@ -797,8 +1456,59 @@ void rtune_objective_set_fidelity_attr(rtune_objective_t *obj, float deviation_t
     obj->lookup_window = lookup_window;
 }
 
+/**
+ * whether the search strategy proposes the values of the list/range var of the func to sample, see rtune_objective_search_1var
+ */
+static int rtune_objective_search_proposes(rtune_objective_attribute_t search_strategy) {
+    switch (search_strategy) {
+        case RTUNE_OBJECTIVE_SEARCH_MODEL:
+        case RTUNE_OBJECTIVE_SEARCH_GOLDEN_SECTION:
+        case RTUNE_OBJECTIVE_SEARCH_BINARY_GRADIENT:
+        case RTUNE_OBJECTIVE_SEARCH_QUATERNARY_GRADIENT:
+        case RTUNE_OBJECTIVE_SEARCH_OCTAL_GRADIENT:
+        case RTUNE_OBJECTIVE_SEARCH_HEX_GRADIENT:
+        case RTUNE_OBJECTIVE_SEARCH_NELDER_MEAD:
+        case RTUNE_OBJECTIVE_SEARCH_RANDOM:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static void rtune_objective_nelder_mead_setup(rtune_objective_t *obj);
+static void rtune_objective_random_setup(rtune_objective_t *obj);
+
+/**
+ * For the search strategies that propose the values to sample, the list/range var of the func of the objective is set to
+ * follow the objective. For RTUNE_OBJECTIVE_SEARCH_MODEL, the func is modeled as USL if it has no model yet. For
+ * RTUNE_OBJECTIVE_SEARCH_NELDER_MEAD and RTUNE_OBJECTIVE_SEARCH_RANDOM, all the vars of the func follow the objective, see
+ * rtune_objective_nelder_mead_setup and rtune_objective_random_setup, and the objective falls back to
+ * RTUNE_OBJECTIVE_SEARCH_DEFAULT if they cannot be set up.
+ */
 void rtune_objective_set_search_strategy(rtune_objective_t *obj, rtune_objective_attribute_t search_strategy) {
     obj->search_strategy = search_strategy;
+    if (search_strategy == RTUNE_OBJECTIVE_SEARCH_NELDER_MEAD && obj->num_funcs > 0) {
+        rtune_objective_nelder_mead_setup(obj);
+    } else if (search_strategy == RTUNE_OBJECTIVE_SEARCH_RANDOM && obj->num_funcs > 0) {
+        rtune_objective_random_setup(obj);
+    } else if (rtune_objective_search_proposes(search_strategy) && obj->num_funcs > 0) {
+        rtune_func_t *func = obj->input_funcs[0].func;
+        if (search_strategy == RTUNE_OBJECTIVE_SEARCH_MODEL && func->model == NULL) rtune_func_set_model(func, RTUNE_MODEL_USL);
+        rtune_var_t *var = func->num_vars > 0 ? func->input_vars[0] : NULL;
+        if (var != NULL && (var->kind == RTUNE_VAR_LIST || var->kind == RTUNE_VAR_RANGE)) {
+            var->update_policy = RTUNE_UPDATE_LIST_FOLLOW_OBJECTIVE;
+            rtune_region_mark_dirty(var->region);
+        }
+    }
+}
+
+/**
+ * The design is generated when RTUNE_OBJECTIVE_SEARCH_RANDOM is set, and again if it is already set.
+ */
+void rtune_objective_set_design(rtune_objective_t *obj, rtune_design_t design, int num_configs) {
+    obj->design = design;
+    obj->num_design_configs = num_configs > 0 ? num_configs : 0;
+    if (obj->search_strategy == RTUNE_OBJECTIVE_SEARCH_RANDOM && obj->num_funcs > 0) rtune_objective_random_setup(obj);
 }
 
 void rtune_objective_set_metaction(rtune_objective_t *obj, rtune_action_t metaction) {
@@ -829,9 +1539,14 @@ void rtune_objective_set_max_mets(rtune_objective_t *obj, int max) {
     obj->max_num_mets = max;
 }
 
+static int rtune_region_retired_hot_status(rtune_region_t * region);
+
 //set the apply policy for all the variables that are the input for the object func. Not sure whether it is useful yet
 void rtune_objective_set_apply_policy(rtune_objective_t * obj,  rtune_var_apply_policy_t apply_policy) {
-    
+    int i;
+    for (i = 0; i < obj->num_vars; i++) obj->input_vars[i].apply_policy = apply_policy;
+    rtune_region_t *region = obj->region;
+    if (region->status == RTUNE_STATUS_RETIRED) region->hot_status = rtune_region_retired_hot_status(region);
 }
 
 void rtune_objective_add_callback(rtune_objective_t * obj, void (*callback) (rtune_objective_t *, void *), void *arg) {
@@ -845,33 +1560,146 @@ inline static utype_t rtune_stvar_apply(stvar_t * stvar, int index) {
     return v;
 }
 
+/**
+ * the generation before the value is applied, so a change outside rtune during the apply is not taken as the value of rtune
+ */
+inline static unsigned long rtune_apply_check_snapshot(rtune_apply_check_t * check) {
+    return check->generation != NULL ? *check->generation : 0;
+}
+
+/**
+ * record the value that was just applied so a later apply of the same value can be skipped, see rtune_apply_check_t
+ */
+inline static void rtune_apply_check_record(rtune_apply_check_t * check, utype_t value, unsigned long generation) {
+    check->applied_value = value;
+    check->applied_generation = generation;
+    check->applied = 1;
+}
+
 static utype_t rtune_var_apply(rtune_var_t * var, int index, int iteration) {
     var->current_apply_index = index;
     var->last_apply_iteration = iteration;
-    return rtune_stvar_apply(&var->stvar, index);
+    unsigned long generation = rtune_apply_check_snapshot(&var->apply_check);
+    utype_t v = rtune_stvar_apply(&var->stvar, index);
+    rtune_apply_check_record(&var->apply_check, v, generation);
+    return v;
+}
+
+/**
+ * whether the value is provably the one in effect in the caller env so the applier call can be skipped. It is if the
+ * reader reads it back, or without a reader, if it was the last value applied and the generation has not been increased
+ * since then. Without a reader and a generation, it is never known.
+ */
+static int rtune_apply_check_current(rtune_apply_check_t * check, const rtune_stvar_ops_t * ops, utype_t v) {
+    if (check->reader != NULL) return ops->equal(ops->read(check->reader, check->reader_arg), v);
+    if (check->generation == NULL || !check->applied || *check->generation != check->applied_generation) return 0;
+    return ops->equal(check->applied_value, v);
+}
+
+/**
+ * apply the value for RTUNE_VAR_APPLY_ON_READ unless it is already in effect
+ * @return 1 if the applier is called, 0 if the call is redundant and skipped
+ */
+static int rtune_apply_on_read(void (*applier) (void *), const rtune_stvar_ops_t * ops, utype_t v, rtune_apply_check_t * check) {
+    if (rtune_apply_check_current(check, ops, v)) return 0;
+    unsigned long generation = rtune_apply_check_snapshot(check);
+    applier(v._typed_value);
+    rtune_apply_check_record(check, v, generation);
+    return 1;
+}
+
+/**
+ * find where the next state of the stvar is stored according to its trace mode, see rtune_trace_mode_t
+ * @return the index, or -1 if the flat trace is full and the state is dropped
+ */
+static inline int rtune_stvar_next_index(stvar_t *stvar) {
+    int index;
+    if (stvar->num_states < stvar->total_num_states) index = stvar->num_states++;
+    else if (stvar->trace_mode == RTUNE_TRACE_RING) index = (int) (stvar->num_updates % stvar->total_num_states);
+    else index = -1;
+    stvar->num_updates++;
+    stvar->last_index = index;
+    return index;
+}
+
+static inline void rtune_stats_update(rtune_stats_t *stats, double x) {
+    long count = ++stats->count;
+    double delta = x - stats->mean;
+    stats->mean += delta / count;
+    stats->m2 += delta * (x - stats->mean);
+    if (count == 1) {
+        stats->min = stats->max = stats->ewma = x;
+    } else {
+        if (x < stats->min) stats->min = x;
+        if (x > stats->max) stats->max = x;
+        stats->ewma += stats->ewma_alpha * (x - stats->ewma);
+    }
+}
+
+/**
+ * clear the states and the statistics of a stvar, e.g. when the var/func is resetted
+ */
+static void rtune_stvar_clear(stvar_t *stvar) {
+    stvar->num_states = 0;
+    stvar->num_updates = 0;
+    stvar->last_index = -1;
+    double ewma_alpha = stvar->stats.ewma_alpha;
+    memset(&stvar->stats, 0, sizeof(rtune_stats_t));
+    stvar->stats.ewma_alpha = ewma_alpha;
+}
+
+void rtune_stvar_set_trace_mode(void * var_or_func, rtune_trace_mode_t mode) {
+    ((stvar_t *) var_or_func)->trace_mode = mode;
+}
+
+void rtune_stvar_set_ewma_alpha(void * var_or_func, double alpha) {
+    ((stvar_t *) var_or_func)->stats.ewma_alpha = alpha;
+}
+
+const rtune_stats_t * rtune_stvar_get_stats(void * var_or_func) {
+    return &((stvar_t *) var_or_func)->stats;
+}
+
+double rtune_stats_variance(const rtune_stats_t * stats) {
+    return stats->count > 1 ? stats->m2 / (stats->count - 1) : 0.0;
+}
+
+double rtune_stats_stddev(const rtune_stats_t * stats) {
+    return sqrt(rtune_stats_variance(stats));
 }
 
 void rtune_var_reset(rtune_var_t * var) {
 	var->status = RTUNE_STATUS_RESETTED;
-	var->stvar.num_states = 0;
+	rtune_stvar_clear(&var->stvar);
+	var->sched_origin = var->region->count + 1; //restart the update schedule from the next iteration
+	rtune_region_mark_dirty(var->region);
 	if (var->kind == RTUNE_VAR_LIST || var->kind == RTUNE_VAR_RANGE) {
 		var->current_v_index = -1;
-		memset(var->count_value, var->num_unique_values, 0);
+		var->proposed_v_index = -1;
+		var->num_random_drawn = 0;
+		memset(var->count_value, 0, sizeof(int) * var->num_unique_values);
 	}
 }
 
 void rtune_func_reset(rtune_func_t * func) {
 	func->status = RTUNE_STATUS_RESETTED;
-	func->stvar.num_states = 0;
+	rtune_stvar_clear(&func->stvar);
+	func->unused_updates = 0;
+	func->num_derived = func->num_input_funcs > 0 ? func->input_funcs[0]->stvar.num_updates : 0; //only derived from new states
+	func->sched_origin = func->region->count + 1;
+	if (func->model != NULL) rtune_model_clear(func->model);
+	rtune_region_mark_dirty(func->region);
 }
 
 void rtune_func_reset_deep(rtune_func_t * func) {
-	func->status = RTUNE_STATUS_RESETTED;
-	func->stvar.num_states = 0;
+	rtune_func_reset(func);
 	int i;
 	for (i=0; i<func->num_vars; i++) {
 		rtune_var_reset(func->input_vars[i]);
 	}
+	for (i=0; i<func->num_input_funcs; i++) {
+		rtune_func_reset_deep(func->input_funcs[i]);
+	}
 }
 
 void rtune_objective_reset(rtune_objective_t * obj) {
@@ -901,14 +1729,18 @@ void rtune_objective_reset_deep(rtune_objective_t * obj) {
     void * provider = stvar->provider;\
     void * provider_arg = stvar->provider_arg;\
     TYPE __state__;\
-    if (provider == provider_arg) {\
+    if (RTUNE_PROVIDER_BUILTIN(stvar->provider_kind)) {\
+        __state__ = (TYPE) rtune_provider_read_builtin(stvar->provider_kind, stvar->provider_arg);\
+    } else if (provider == provider_arg) {\
         __state__ = *((TYPE *)(provider));\
     } else {\
         __state__ = ((TYPE(*)(void *))(provider))(provider_arg);\
     }
 
 #define STVAR_UPDATE_NEXT_STATE(TYPE, stvar) \
-    stvar->v._##TYPE##_value = ((TYPE *)stvar->states)[stvar->num_states++] = __state__; \
+    stvar->v._##TYPE##_value = __state__;                                                \
+    if (rtune_stvar_next_index(stvar) >= 0) ((TYPE *)stvar->states)[stvar->last_index] = __state__; \
+    rtune_stats_update(&stvar->stats, (double) __state__);                              \
     if (stvar->callback) stvar->callback(stvar->callback_arg);                           \
 
 
@@ -927,7 +1759,7 @@ void rtune_objective_reset_deep(rtune_objective_t * obj) {
 /**
  * update the list or range variable
  * @param var
- * @return the index (sequence number) of the state, -1 indicate failure of update
+ * @return the index (sequence number) of the state, -1 indicate failure of update or the state is dropped
  */
 static int rtune_var_update_list_range(rtune_var_t *var) {
     stvar_t *stvar = &var->stvar;
@@ -940,16 +1772,27 @@ static int rtune_var_update_list_range(rtune_var_t *var) {
     } else if (var->update_policy == RTUNE_UPDATE_LIST_SERIES_CYCLIC) {
         index = (var->current_v_index + 1) % num_values;
     } else if (var->update_policy == RTUNE_UPDATE_LIST_RANDOM) {
-        index = random() % num_values; //TODO: random call need seed call for the whole program with srand(time(0)). right now, we do not know where to put this srand call
+        index = rtune_rng_below(&var->region->rng_state, num_values);
     } else if (var->update_policy == RTUNE_UPDATE_LIST_RANDOM_UNIQUE) {
-        if (num_values > stvar->num_states) {
-            while (1) {
-                index = random() % num_values;
-                if (var->count_value[index] == 0)
-                    break;
-            }
-        } else {
-            return -1;
+        //draw the next value of a random permutation of the values, i.e. one step of Fisher-Yates on the values not drawn yet
+        if (var->random_order == NULL) {
+            var->random_order = (int *) rtune_arena_alloc(&var->region->arena, sizeof(int) * num_values);
+            if (var->random_order == NULL) return -1;
+            for (index = 0; index < num_values; index++) var->random_order[index] = index;
+        }
+        if (var->num_random_drawn >= num_values) return -1;
+        int k = var->num_random_drawn + rtune_rng_below(&var->region->rng_state, num_values - var->num_random_drawn);
+        index = var->random_order[k];
+        var->random_order[k] = var->random_order[var->num_random_drawn];
+        var->random_order[var->num_random_drawn++] = index;
+    } else if (var->update_policy == RTUNE_UPDATE_LIST_FOLLOW_OBJECTIVE) {
+        //the value proposed by the objective, or the next value not set yet in the list/range order if there is no proposal
+        index = var->proposed_v_index;
+        var->proposed_v_index = -1;
+        if (index < 0) {
+            index = var->current_v_index + 1;
+            while (index < num_values && var->count_value[index] > 0) index++;
+            if (index >= num_values) return -1;
         }
     } else {
         return -1;
@@ -958,43 +1801,11 @@ static int rtune_var_update_list_range(rtune_var_t *var) {
     var->current_v_index = index;
     var->count_value[index] ++;
 
-    if (var->kind == RTUNE_VAR_LIST) {
-        switch (stvar->type) {
-            case RTUNE_short:
-                RTUNE_VAR_UPDATE_LIST(short, var, stvar, index); break;
-            case RTUNE_int:
-                RTUNE_VAR_UPDATE_LIST(int, var, stvar, index); break;
-            case RTUNE_long:
-                RTUNE_VAR_UPDATE_LIST(long, var, stvar, index); break;
-            case RTUNE_float:
-                RTUNE_VAR_UPDATE_LIST(float, var, stvar, index); break;
-            case RTUNE_double:
-                RTUNE_VAR_UPDATE_LIST(double, var, stvar, index); break;
-            default:
-                //error
-                break;
-        }
-    }
-
-    if (var->kind == RTUNE_VAR_RANGE) {
-        switch (stvar->type) {
-            case RTUNE_short:
-                RTUNE_VAR_UPDATE_RANGE(short, var, stvar, index); break;
-            case RTUNE_int:
-                RTUNE_VAR_UPDATE_RANGE(int, var, stvar, index); break;
-            case RTUNE_long:
-                RTUNE_VAR_UPDATE_RANGE(long, var, stvar, index); break;
-            case RTUNE_float:
-                RTUNE_VAR_UPDATE_RANGE(float, var, stvar, index); break;
-            case RTUNE_double:
-                RTUNE_VAR_UPDATE_RANGE(double, var, stvar, index); break;
-            default:
-                //error
-                break;
-        }
-    }
+    if (var->kind == RTUNE_VAR_LIST) stvar->ops->update_list(var, index);
+    else if (var->kind == RTUNE_VAR_RANGE) stvar->ops->update_range(var, index);
 
-    return index;
+    //the state is not the index-th value unless the values are set in the list/range order
+    return stvar->last_index;
 }
 
 #define RTUNE_STVAR_UPDATE_EXT(TYPE, stvar)  \
@@ -1003,24 +1814,6 @@ static int rtune_var_update_list_range(rtune_var_t *var) {
         STVAR_UPDATE_NEXT_STATE(TYPE, stvar); \
     }
 
-void * rtune_var_update_ext_straight (stvar_t *stvar) {
-    switch (stvar->type) {
-        case RTUNE_short:
-        RTUNE_STVAR_UPDATE_EXT(short, stvar); break;
-        case RTUNE_int:
-        RTUNE_STVAR_UPDATE_EXT(int, stvar); break;
-        case RTUNE_long:
-        RTUNE_STVAR_UPDATE_EXT(long, stvar); break;
-        case RTUNE_float:
-        RTUNE_STVAR_UPDATE_EXT(float, stvar); break;
-        case RTUNE_double:
-        RTUNE_STVAR_UPDATE_EXT(double, stvar); break;
-        default:
-            //error
-            break;
-    }
-}
-
 #define RTUNE_STVAR_UPDATE_EXT_accu4Begin(TYPE, stvar, update)  \
     {\
         STVAR_GET_NEXT_STATE(TYPE, stvar)           \
@@ -1032,48 +1825,12 @@ void * rtune_var_update_ext_straight (stvar_t *stvar) {
         }            \
     }
 
-void rtune_stvar_update_ext_accu4Begin (stvar_t *stvar, int update) {
-    switch (stvar->type) {
-        case RTUNE_short:
-        RTUNE_STVAR_UPDATE_EXT_accu4Begin(short, stvar, update); break;
-        case RTUNE_int:
-        RTUNE_STVAR_UPDATE_EXT_accu4Begin(int, stvar, update); break;
-        case RTUNE_long:
-        RTUNE_STVAR_UPDATE_EXT_accu4Begin(long, stvar, update); break;
-        case RTUNE_float:
-        RTUNE_STVAR_UPDATE_EXT_accu4Begin(float, stvar, update); break;
-        case RTUNE_double:
-        RTUNE_STVAR_UPDATE_EXT_accu4Begin(double, stvar, update); break;
-        default:
-            //error
-            break;
-    }
-}
-
 #define RTUNE_STVAR_UPDATE_DIFF_base4Diff(TYPE, stvar)  \
     {\
         STVAR_GET_NEXT_STATE(TYPE, stvar)           \
         stvar->accu4Begin_or_base4Diff._##TYPE##_value = __state__;\
     }
 
-void rtune_stvar_update_diff_base4Diff (stvar_t *stvar) {
-    switch (stvar->type) {
-        case RTUNE_short:
-        RTUNE_STVAR_UPDATE_DIFF_base4Diff(short, stvar); break;
-        case RTUNE_int:
-        RTUNE_STVAR_UPDATE_DIFF_base4Diff(int, stvar); break;
-        case RTUNE_long:
-        RTUNE_STVAR_UPDATE_DIFF_base4Diff(long, stvar); break;
-        case RTUNE_float:
-        RTUNE_STVAR_UPDATE_DIFF_base4Diff(float, stvar); break;
-        case RTUNE_double:
-        RTUNE_STVAR_UPDATE_DIFF_base4Diff(double, stvar); break;
-        default:
-            //error
-            break;
-    }
-}
-
 #define RTUNE_STVAR_UPDATE_EXT_accu4End(TYPE, stvar, update)  \
     {\
         STVAR_GET_NEXT_STATE(TYPE, stvar)           \
@@ -1085,24 +1842,6 @@ void rtune_stvar_update_diff_base4Diff (stvar_t *stvar) {
         }            \
     }
 
-void rtune_stvar_update_ext_accu4End (stvar_t *stvar, int update) {
-    switch (stvar->type) {
-        case RTUNE_short:
-        RTUNE_STVAR_UPDATE_EXT_accu4End(short, stvar, update); break;
-        case RTUNE_int:
-        RTUNE_STVAR_UPDATE_EXT_accu4End(int, stvar, update); break;
-        case RTUNE_long:
-        RTUNE_STVAR_UPDATE_EXT_accu4End(long, stvar, update); break;
-        case RTUNE_float:
-        RTUNE_STVAR_UPDATE_EXT_accu4End(float, stvar, update); break;
-        case RTUNE_double:
-        RTUNE_STVAR_UPDATE_EXT_accu4End(double, stvar, update); break;
-        default:
-            //error
-            break;
-    }
-}
-
 #define RTUNE_STVAR_UPDATE_DIFF_accu4Diff(TYPE, stvar, update)  \
     {\
         STVAR_GET_NEXT_STATE(TYPE, stvar)                  \
@@ -1114,22 +1853,95 @@ void rtune_stvar_update_ext_accu4End (stvar_t *stvar, int update) {
         }                                                       \
     }
 
-void rtune_stvar_update_diff_accu4Diff (stvar_t *stvar, int update) {
-    switch (stvar->type) {
-        case RTUNE_short:
-        RTUNE_STVAR_UPDATE_DIFF_accu4Diff(short, stvar, update); break;
-        case RTUNE_int:
-        RTUNE_STVAR_UPDATE_DIFF_accu4Diff(int, stvar, update); break;
-        case RTUNE_long:
-        RTUNE_STVAR_UPDATE_DIFF_accu4Diff(long, stvar, update); break;
-        case RTUNE_float:
-        RTUNE_STVAR_UPDATE_DIFF_accu4Diff(float, stvar, update); break;
-        case RTUNE_double:
-        RTUNE_STVAR_UPDATE_DIFF_accu4Diff(double, stvar, update); break;
-        default:
-            //error
+/**
+ * whether the update policy is a batch reducer, see RTUNE_UPDATE_BATCH_MEDIAN
+ */
+static inline int rtune_batch_reducer(rtune_var_update_kind_t update_policy) {
+    return update_policy >= RTUNE_UPDATE_BATCH_MEDIAN && update_policy <= RTUNE_UPDATE_BATCH_MEAN_STDDEV;
+}
+
+/**
+ * read the value of an ext stvar from its provider as double, a built-in provider is read inline
+ */
+static inline double rtune_stvar_read_as_double(stvar_t * stvar) {
+    if (RTUNE_PROVIDER_BUILTIN(stvar->provider_kind)) return rtune_provider_read_builtin(stvar->provider_kind, stvar->provider_arg);
+    return stvar->ops->to_double(stvar->ops->read(stvar->provider, stvar->provider_arg));
+}
+
+static int rtune_double_compare(const void *a, const void *b) {
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+static double rtune_sorted_median(const double *values, int n) {
+    return n % 2 ? values[n/2] : (values[n/2 - 1] + values[n/2]) / 2;
+}
+
+static void rtune_mean_stddev(const double *values, int n, double *mean, double *stddev) {
+    double sum = 0.0, sum2 = 0.0;
+    int i;
+    for (i = 0; i < n; i++) sum += values[i];
+    *mean = sum / n;
+    for (i = 0; i < n; i++) sum2 += (values[i] - *mean) * (values[i] - *mean);
+    *stddev = n > 1 ? sqrt(sum2 / (n - 1)) : 0.0;
+}
+
+/**
+ * collect the value of an iteration of a batch for a batch reducer, and reduce the values of the batch into a new state
+ * of the stvar at the last iteration of the batch. The dispersion of the batch is recorded for the new state.
+ * @return the index of the new state, -1 if the batch is not complete yet
+ */
+static int rtune_stvar_batch_reduce(stvar_t * stvar, rtune_var_update_kind_t update_policy, double x, int batch_index, int batch_size) {
+    if (batch_index == 0) stvar->num_batch_values = 0;
+    if (stvar->num_batch_values < stvar->batch_capacity) stvar->batch_values[stvar->num_batch_values++] = x;
+    if (batch_index != batch_size - 1 || stvar->num_batch_values == 0) return -1;
+
+    double *values = stvar->batch_values;
+    int n = stvar->num_batch_values;
+    double value, dispersion;
+    int i;
+    switch (update_policy) {
+        case RTUNE_UPDATE_BATCH_MEDIAN:
+            qsort(values, n, sizeof(double), rtune_double_compare);
+            value = rtune_sorted_median(values, n);
+            for (i = 0; i < n; i++) values[i] = fabs(values[i] - value);
+            qsort(values, n, sizeof(double), rtune_double_compare);
+            dispersion = rtune_sorted_median(values, n);
+            break;
+        case RTUNE_UPDATE_BATCH_TRIMMED_MEAN: {
+            qsort(values, n, sizeof(double), rtune_double_compare);
+            int trim = (int) (n * DEFAULT_batch_trim_ratio);
+            rtune_mean_stddev(values + trim, n - 2 * trim, &value, &dispersion);
+            break;
+        }
+        case RTUNE_UPDATE_BATCH_MIN:
+            rtune_mean_stddev(values, n, &value, &dispersion);
+            value = values[0];
+            for (i = 1; i < n; i++) if (values[i] < value) value = values[i];
             break;
+        default: //RTUNE_UPDATE_BATCH_MEAN_STDDEV
+            rtune_mean_stddev(values, n, &value, &dispersion);
+            break;
+    }
+    stvar->num_batch_values = 0;
+    stvar->ops->push(stvar, stvar->ops->from_double(value));
+    if (stvar->last_index >= 0 && stvar->dispersion != NULL) stvar->dispersion[stvar->last_index] = dispersion;
+    return stvar->last_index;
+}
+
+/**
+ * allocate the batch buffer and the dispersion column of a stvar that is updated by a batch reducer
+ */
+static void rtune_stvar_reserve_batch(rtune_region_t * region, stvar_t * stvar, int batch_size, int num_states) {
+    if (stvar->batch_capacity < batch_size) {
+        double *batch_values = (double *) rtune_arena_alloc(&region->arena, sizeof(double) * batch_size);
+        if (batch_values == NULL) return;
+        stvar->batch_values = batch_values;
+        stvar->batch_capacity = batch_size;
+        stvar->num_batch_values = 0;
     }
+    if (stvar->dispersion == NULL) stvar->dispersion = (double *) rtune_arena_alloc(&region->arena, sizeof(double) * num_states);
 }
 
 /**
@@ -1145,16 +1957,20 @@ static int rtune_stvar_ext_update_begin(stvar_t * stvar, rtune_var_update_kind_t
     switch (update_policy) {
         case RTUNE_UPDATE_BATCH_STRAIGHT:
             if (batch_index == 0) {//only update the var if it is batch_straight
-                rtune_var_update_ext_straight(stvar);
-                index = stvar->num_states-1;
+                stvar->ops->update_ext_straight(stvar);
+                index = stvar->last_index;
             }
             break;
         case RTUNE_UPDATE_BATCH_ACCUMULATE:;
             int update = batch_index == batch_size - 1;
-            rtune_stvar_update_ext_accu4Begin(stvar, update) ;
-            if (update) index = stvar->num_states-1;
+            stvar->ops->update_ext_accu4Begin(stvar, update);
+            if (update) index = stvar->last_index;
             break;
         default:
+            if (rtune_batch_reducer(update_policy)) {
+                double x = rtune_stvar_read_as_double(stvar);
+                index = rtune_stvar_batch_reduce(stvar, update_policy, x, batch_index, batch_size);
+            }
             break;
     }
     return index;
@@ -1164,13 +1980,14 @@ static void rtune_stvar_ext_diff_update_begin(stvar_t * stvar, rtune_var_update_
     switch (update_policy) {
         case RTUNE_UPDATE_BATCH_STRAIGHT:
             if (batch_index == 0) {//only update the var if it is batch_straight
-                rtune_stvar_update_diff_base4Diff(stvar);
+                stvar->ops->update_diff_base4Diff(stvar);
             }
             break;
         case RTUNE_UPDATE_BATCH_ACCUMULATE:
-            rtune_stvar_update_diff_base4Diff(stvar);
+            stvar->ops->update_diff_base4Diff(stvar);
             break;
         default:
+            if (rtune_batch_reducer(update_policy)) stvar->ops->update_diff_base4Diff(stvar); //the base of each iteration
             break;
     }
 }
@@ -1188,16 +2005,20 @@ static int rtune_stvar_ext_update_end(stvar_t * stvar, rtune_var_update_kind_t u
     switch (update_policy) {
         case RTUNE_UPDATE_BATCH_STRAIGHT:
             if (batch_index == 0) {//only update the var if it is batch_straight
-                rtune_var_update_ext_straight(stvar);
-                index = stvar->num_states-1;
+                stvar->ops->update_ext_straight(stvar);
+                index = stvar->last_index;
             }
             break;
         case RTUNE_UPDATE_BATCH_ACCUMULATE:;
             int update = batch_index == batch_size - 1;
-            rtune_stvar_update_ext_accu4End(stvar, update) ;
-            if (update) index = stvar->num_states-1;
+            stvar->ops->update_ext_accu4End(stvar, update);
+            if (update) index = stvar->last_index;
             break;
         default:
+            if (rtune_batch_reducer(update_policy)) {
+                double x = rtune_stvar_read_as_double(stvar);
+                index = rtune_stvar_batch_reduce(stvar, update_policy, x, batch_index, batch_size);
+            }
             break;
     }
     return index;
@@ -1207,17 +2028,21 @@ static int rtune_stvar_ext_diff_update_end(stvar_t * stvar, rtune_var_update_kin
     int index = -1;
     switch (update_policy) {
         case RTUNE_UPDATE_BATCH_STRAIGHT:
-            if (batch_index == 0) {//only update the var if it is batch_straight
-                rtune_stvar_update_diff_base4Diff(stvar);
-                index = stvar->num_states-1;
+            if (batch_index == 0) {//only update the var if it is batch_straight, the diff is of the first iteration of the batch
+                stvar->ops->update_diff_accu4Diff(stvar, 1);
+                index = stvar->last_index;
             }
             break;
         case RTUNE_UPDATE_BATCH_ACCUMULATE:;
             int update = batch_index == batch_size - 1;
-            rtune_stvar_update_diff_accu4Diff(stvar, update);
-            if (update) index = stvar->num_states-1;
+            stvar->ops->update_diff_accu4Diff(stvar, update);
+            if (update) index = stvar->last_index;
             break;
         default:
+            if (rtune_batch_reducer(update_policy)) {
+                double x = rtune_stvar_read_as_double(stvar) - stvar->ops->to_double(stvar->accu4Begin_or_base4Diff);
+                index = rtune_stvar_batch_reduce(stvar, update_policy, x, batch_index, batch_size);
+            }
             break;
     }
     return index;
@@ -1245,15 +2070,61 @@ static void rtune_func_print_doubleFunc_intVar(rtune_func_t * func, int count) {
     for (j=0; j<func->num_vars; j++) {
         rtune_var_t * var = func->input_vars[j];
         printf("var %s: ", var->stvar.name);
+        rtune_column_t column = rtune_func_column_var(func, j); //the values of the var of the samples, of any type
         for (i=0; i<num_states; i++) {
-            int vi = func->input[i*func->num_vars + j];
-            printf("\t%d", ((int*)var->stvar.states)[vi]);
+            printf("\t%g", rtune_column_double(column, i));
         }
         printf("\n");
     }
     printf("================================================================================\n");
 }
 
+/**
+ * the index of the state at position p of the states of the stvar in time order, 0 is the oldest. Once a ring trace wraps,
+ * the oldest state is the one after the newest, see rtune_stvar_next_index
+ */
+static inline int rtune_stvar_state_index(stvar_t *stvar, int p) {
+    if (stvar->trace_mode != RTUNE_TRACE_RING || stvar->num_states < stvar->total_num_states || stvar->last_index < 0) return p;
+    return (stvar->last_index + 1 + p) % stvar->total_num_states;
+}
+
+/**
+ * the number of consecutive pairs of the states from position start (in time order, see rtune_stvar_state_index) to the
+ * newest one that show the trend (increasing or decreasing) by at least tolerance of relative deviation. A pair whose
+ * difference is within the dispersion of the batches the two states are reduced from can be noise rather than a trend and
+ * is not counted, see rtune_kernel_trend. The states of a wrapped ring trace are scanned as the two segments before and
+ * after the end of the trace, and the pair across the end is checked on its own.
+ */
+static int rtune_stvar_trend(stvar_t *stvar, int start, double tolerance, int increasing) {
+    size_t size = stvar->ops->size;
+    int count = stvar->num_states - start;
+    int first = rtune_stvar_state_index(stvar, start);
+    int head = first + count <= stvar->num_states ? count : stvar->num_states - first; //the states up to the end of the trace
+    const double *dispersion = stvar->dispersion != NULL ? stvar->dispersion + first : NULL;
+    int trend = rtune_kernel_trend(stvar->type, (const char *) stvar->states + (size_t) first * size, dispersion, head, tolerance, increasing);
+    if (head < count) {
+        char pair[2 * sizeof(utype_t)];
+        double pair_dispersion[2];
+        int last = stvar->num_states - 1;
+        memcpy(pair, (const char *) stvar->states + (size_t) last * size, size);
+        memcpy(pair + size, stvar->states, size);
+        if (stvar->dispersion != NULL) {
+            pair_dispersion[0] = stvar->dispersion[last];
+            pair_dispersion[1] = stvar->dispersion[0];
+        }
+        trend += rtune_kernel_trend(stvar->type, pair, stvar->dispersion != NULL ? pair_dispersion : NULL, 2, tolerance, increasing);
+        trend += rtune_kernel_trend(stvar->type, stvar->states, stvar->dispersion, count - head, tolerance, increasing);
+    }
+    return trend;
+}
+
+/**
+ * the index of the newest state of the stvar, which is the last one of a flat trace that drops the states after it is full
+ */
+static inline int rtune_stvar_newest_index(stvar_t *stvar) {
+    return stvar->last_index >= 0 ? stvar->last_index : stvar->num_states - 1;
+}
+
 /**
  * optimization of a unimodal function to find the min. A unimodal function has only one min/max and
  * @param obj
@@ -1270,35 +2141,19 @@ static int rtune_objective_min_unimodal_gradient_1var(rtune_objective_t *obj) {
 
     //assert func_stvar->num_states == var_stvar->num_states;
     int num_states = func_stvar->num_states;
-    int i;
 
     //requires at least fidelity-trust-window number of states to calculate the gradient
     int window_end = num_states - obj->lookup_window;
+    if (window_end < 0) window_end = 0;
     //calculate gradient of the last fidelity_window number of states
-    int trend_decreasing = 0;
-    int trend_increasing = 0;
-    int trend_flat = 0;
-    if (func_stvar->type == RTUNE_double) {
-        double *func_states = (double *) func_stvar->states;
-        for (i = num_states - 1; i > window_end; i--) {
-            double func1 = ((double *) (func_stvar->states))[i];
-            double func0 = ((double *) (func_stvar->states))[i-1];
-
-            float deviation_tolerance = obj->deviation_tolerance;
-            double deviation = func1 - func0;
-            double deviationPercentage = fabs(deviation)/func0;
-            if (deviationPercentage >= deviation_tolerance && deviation >= 0) {//must see consecutive increasing
-                trend_increasing++;
-                printf("trend increasing from [%d]:%.2f->[%d]:%.2f (%.2f%%) and greater tolerance(%0.2f%%)\n", i-1, func0, i, func1, deviationPercentage * 100, deviation_tolerance*100);
-            } else { //deviation == 0,
-        //    	trend_increasing = 0;
-            }
-        }
-        if (trend_increasing >= obj->fidelity_window) { //trend_increasing should be at least the same as fidelity window consecutively to be considered as obj being met
-            int index = num_states - trend_increasing - 1;
-            printf("********* min (%d) reached within %d (fidelity window) increasing ****************\n", index, obj->fidelity_window);
-            return index;
-        }
+    int trend_increasing = rtune_stvar_trend(func_stvar, window_end, obj->deviation_tolerance, 1);
+    if (trend_increasing > 0) {
+        printf("trend increasing in %d of the last %d states and greater than tolerance(%0.2f%%)\n", trend_increasing, num_states - window_end, obj->deviation_tolerance*100);
+    }
+    if (trend_increasing >= obj->fidelity_window) { //trend_increasing should be at least the same as fidelity window consecutively to be considered as obj being met
+        int index = rtune_stvar_state_index(func_stvar, num_states - trend_increasing - 1);
+        printf("********* min (%d) reached within %d (fidelity window) increasing ****************\n", index, obj->fidelity_window);
+        return index;
     }
 
     return -1;
@@ -1307,7 +2162,8 @@ static int rtune_objective_min_unimodal_gradient_1var(rtune_objective_t *obj) {
 /**
  * This function find the min in the state starting from index start for count number of elements. If a pointer (minValue) to a variable
  * is provided, the value in the variable will be included for finding the min, and the min found by this function will be copied
- * back to the minValue pointer variable
+ * back to the minValue pointer variable. The states are scanned by rtune_kernel_argmin, which returns the last index of the
+ * min if there are ties, as the scalar scan with <= did
  * @param stvar: the stvar
  * @param start: starting states
  * @param count: the number of states to look for the min
@@ -1316,736 +2172,2039 @@ static int rtune_objective_min_unimodal_gradient_1var(rtune_objective_t *obj) {
  */
 #define STVAR_FIND_MIN_EXHAUSTIVE(TYPE, stvar, start, count, minIndex, minValue) \
     TYPE *states = (TYPE*) stvar->states;          \
-    TYPE temp = minValue->_##TYPE##_value; \
-    int foundNewMin = 0; \
-    int i;                          \
-    for(i=start; i<start+count; i++) {           \
-        if (states[i] <= temp ) {            \
-            temp = states[i];                \
-            minIndex = i;                  \
-            foundNewMin = 1; \
-        }                                 \
-    } \
-	if (foundNewMin) { minValue->_##TYPE##_value = temp; }
+    int i = rtune_kernel_argmin(RTUNE_##TYPE, states + start, count); \
+    if (i >= 0 && states[start + i] <= minValue->_##TYPE##_value) { \
+        minIndex = start + i; \
+        minValue->_##TYPE##_value = states[minIndex]; \
+    }
 
 
 int rtune_stvar_find_min(stvar_t * stvar, int start, int count, utype_t *minValue) {
 	int num_states = stvar->num_states;
-	if (start + count > num_states) return -1;
-
-    int index = -1;
-    if (stvar->type == RTUNE_short) {
-        STVAR_FIND_MIN_EXHAUSTIVE(short, stvar, start, count, index, minValue);
-    } else if (stvar->type == RTUNE_int) {
-        STVAR_FIND_MIN_EXHAUSTIVE(int, stvar, start, count, index, minValue);
-    } else if (stvar->type == RTUNE_long) {
-        STVAR_FIND_MIN_EXHAUSTIVE(long, stvar, start, count, index, minValue);
-    } else if (stvar->type == RTUNE_float) {
-        STVAR_FIND_MIN_EXHAUSTIVE(float, stvar, start, count, index, minValue);
-    } else if (stvar->type == RTUNE_double) {
-        STVAR_FIND_MIN_EXHAUSTIVE(double, stvar, start, count, index, minValue);
-    } else index = -1;
-    return index;
+	if (start < 0 || start + count > num_states) return -1;
+    return stvar->ops->find_min(stvar, start, count, minValue);
 }
 
+int rtune_stvar_find_max(stvar_t * stvar, int start, int count, utype_t *maxValue);
+
 /**
- * optimization of a unimodal function to find the max. A unimodal function has only one min/max and
- * @param obj
- * @return We would like the function return the index if the max is found. If the max is not found, the function should
- *         return a value that representing the direction of searching (increment or decrement).
+ * Model-based search of a func over a list/range var that follows the objective, see RTUNE_UPDATE_LIST_FOLLOW_OBJECTIVE.
+ * Until the model of the func is trusted (see rtune_model_t), the value farthest from the sampled ones is proposed to spread
+ * the samples over the list/range. Then the objective is MODELED, and the value nearest to the optimum the model predicts
+ * and its two neighbours are proposed until they are all sampled. As each new sample refits the model, a wrong prediction
+ * moves the neighbourhood to be confirmed.
+ * @return the index of the best state of the func once the neighbourhood (or the whole list/range) is sampled, -1 if a
+ *         value is proposed for the next sample
  */
-static int rtune_objective_max_unimodal_gradient_1var(rtune_objective_t *obj) {
+static int rtune_objective_model_1var(rtune_objective_t *obj, int maximize) {
     rtune_func_t *func = obj->input_funcs[0].func;
-    stvar_t *func_stvar = &func->stvar;
-
-    rtune_var_t *avar = func->active_var;
-    stvar_t *avar_stvar = &avar->stvar;
-    rtune_var_t *var = func->input_vars[0]; //this should be the active avar
-
-    //assert func_stvar->num_states == var_stvar->num_states;
-    int num_states = func_stvar->num_states;
-    int i;
-
-    //requires at least fidelity-trust-window number of states to calculate the gradient
-    int window_end;
-    if (num_states < obj->lookup_window) { //as long as the last fidelity_window amount of sampling data shows increase, we are good for meeting the obj
-        return -1;
+    rtune_var_t *var = func->input_vars[0];
+    int num_values = var->num_unique_values;
+    int propose = -1;
+    int u, v;
+    double lo, hi, x;
+    rtune_var_value_bounds(var, &lo, &hi);
+
+    if (func->model != NULL && func->model->modeled && rtune_model_optimum(func->model, maximize, lo, hi, &x) == 0) {
+        if (obj->status < RTUNE_STATUS_MODELED) obj->status = RTUNE_STATUS_MODELED;
+        int nearest = 0;
+        for (v = 1; v < num_values; v++) {
+            if (fabs(rtune_var_value_double(var, v) - x) < fabs(rtune_var_value_double(var, nearest) - x)) nearest = v;
+        }
+        int neighbourhood[3] = {nearest, nearest - 1, nearest + 1};
+        for (u = 0; u < 3 && propose < 0; u++) {
+            v = neighbourhood[u];
+            if (v >= 0 && v < num_values && var->count_value[v] == 0) propose = v;
+        }
+        printf("model of func %s predicts the %s at %s = %.2f (r2: %.3f)\n", func->stvar.name, maximize ? "max" : "min",
+               var->stvar.name, x, func->model->r2);
     } else {
-        window_end = num_states - obj->lookup_window;
-    }
-    //calculate gradient of the last fidelity_window number of states
-    int trend_decreasing = 0;
-    int trend_increasing = 0;
-    int trend_flat = 0;
-    if (func_stvar->type == RTUNE_double) {
-        double *func_states = (double *) func_stvar->states;
-        for (i = num_states - 1; i > window_end; i--) {
-            double func1 = ((double *) (func_stvar->states))[i];
-            double func0 = ((double *) (func_stvar->states))[i-1];
-
-            float deviation_tolerance = obj->deviation_tolerance;
-            double deviation = func1 - func0;
-            double deviationPercentage = fabs(deviation)/func0;
-            if (deviationPercentage >= deviation_tolerance && deviation <= 0) {//must see consecutive decreasing
-            	trend_decreasing++;
-                printf("trend decreasing from [%d]:%.2f->[%d]:%.2f (%.2f%%) and greater than tolerance(%0.2f%%)\n", i-1, func0, i, func1, deviationPercentage * 100, deviation_tolerance*100);
-            } else { //deviation == 0,
-        //    	trend_increasing = 0;
+        int max_distance = 0;
+        for (v = 0; v < num_values; v++) {
+            if (var->count_value[v] > 0) continue;
+            int distance = INT_MAX;
+            for (u = 0; u < num_values; u++) {
+                if (var->count_value[u] > 0 && abs(u - v) < distance) distance = abs(u - v);
+            }
+            if (distance > max_distance) {
+                max_distance = distance;
+                propose = v;
             }
         }
-        if (trend_decreasing >= obj->fidelity_window) { //trend_increasing should be at least the same as fidelity window consecutively to be considered as obj being met
-            int index = num_states - trend_decreasing - 1;
-            printf("********* max (%d) reached within %d (fidelity window) decreasing ****************\n", index, obj->fidelity_window);
-            return index;
-        }
+    }
+    if (propose >= 0) {
+        var->proposed_v_index = propose;
+        return -1;
     }
 
-    return -1;
+    utype_t value;
+    if (maximize) {
+        set_min(&value, func->stvar.type);
+        return rtune_stvar_find_max(&func->stvar, 0, func->stvar.num_states, &value);
+    }
+    set_max(&value, func->stvar.type);
+    return rtune_stvar_find_min(&func->stvar, 0, func->stvar.num_states, &value);
 }
 
 /**
- * This function find the max in the state starting from index start for count number of elements. If a pointer (minValue) to a variable
- * is provided, the value in the variable will be included for finding the max, and the max found by this function will be copied
- * back to the minValue pointer variable
- * @param stvar: the stvar
- * @param start: starting states
- * @param count: the number of states to look for the max
- * @param maxValue: if provided, to provide the initial max value for comparison and be used for returning the initial value
- * @return: the index of the state that has the max, if not found, return -1
+ * the state of a func that is sampled with the v-th value of its list/range var, the newest one if the value is sampled
+ * more than once. The sample store is the memo of the searches, a value is never proposed again once it has a state.
+ * @return the index of the state, -1 if the value is not sampled yet
  */
-#define STVAR_FIND_MAX_EXHAUSTIVE(TYPE, stvar, start, count, maxIndex, maxValue) \
-    TYPE *states = (TYPE*) stvar->states;          \
-    TYPE temp = maxValue->_##TYPE##_value; \
-    int foundNewMax = 0; \
-    int i;                          \
-    for(i=start; i<start+count; i++) {           \
-        if (states[i] <= temp ) {            \
-            temp = states[i];                \
-            maxIndex = i;                  \
-            foundNewMax = 1; \
-        }                                 \
-    } \
-	if (foundNewMax) { maxValue->_##TYPE##_value = temp; }
-
-
-int rtune_stvar_find_max(stvar_t * stvar, int start, int count, utype_t *maxValue) {
-	int num_states = stvar->num_states;
-	if (start + count > num_states) return -1;
-
-    int index = -1;
-    if (stvar->type == RTUNE_short) {
-        STVAR_FIND_MAX_EXHAUSTIVE(short, stvar, start, count, index, maxValue);
-    } else if (stvar->type == RTUNE_int) {
-        STVAR_FIND_MAX_EXHAUSTIVE(int, stvar, start, count, index, maxValue);
-    } else if (stvar->type == RTUNE_long) {
-        STVAR_FIND_MAX_EXHAUSTIVE(long, stvar, start, count, index, maxValue);
-    } else if (stvar->type == RTUNE_float) {
-        STVAR_FIND_MAX_EXHAUSTIVE(float, stvar, start, count, index, maxValue);
-    } else if (stvar->type == RTUNE_double) {
-        STVAR_FIND_MAX_EXHAUSTIVE(double, stvar, start, count, index, maxValue);
-    } else index = -1;
-    return index;
+static int rtune_func_state_of_value(rtune_func_t *func, rtune_var_t *var, int v) {
+    int s;
+    if (var->count_value[v] == 0) return -1;
+    rtune_column_t values = rtune_func_column_var(func, 0);
+    for (s = func->stvar.num_states - 1; s >= 0; s--) {
+        int index = rtune_stvar_state_index(&func->stvar, s);
+        if (rtune_var_value_index(var, rtune_column_double(values, index)) == v) return index;
+    }
+    return -1;
 }
 
-void rtune_region_begin(rtune_region_t * region) {
-    //printf("RTune region: %s(%x) begin, count: %d\n", region->name, region, count);
-    //we need a flag to simply ignore the rest if rtune's job is done
-    int count = ++region->count;
-    if (region->status == RTUNE_STATUS_RETIRED) {
-        //TODO: check to see whether we need to apply the config for those var that are needed to do for each iteration
-    	return;
+/**
+ * Fibonacci search of a unimodal func over a list/range var that follows the objective. The n values are padded to
+ * F(k)-1 values, F(k) >= n+1, with the padding worse than any value, and the open bracket (lo, lo+F(k)) is narrowed
+ * to (lo, lo+F(k-1)) or (lo+F(k-2), lo+F(k)) by comparing the two points lo+F(k-2) and lo+F(k-1) in it. One of
+ * the two points is a point of the next bracket, so each step samples only one new value, as the golden-section search
+ * does with the ratio of consecutive Fibonacci numbers. The search is replayed from the full bracket on each
+ * evaluation with the sampled values, and the first point that is not sampled yet is proposed.
+ * @return the index of the state of the func at the last point of the bracket, -1 if a value is proposed for the next sample
+ */
+static int rtune_objective_golden_section_1var(rtune_objective_t *obj, int maximize) {
+    rtune_func_t *func = obj->input_funcs[0].func;
+    rtune_var_t *var = func->input_vars[0];
+    int num_values = var->num_unique_values;
+    rtune_column_t func_values = rtune_func_column_value(func);
+    int fib[48] = {0, 1};
+    int k = 1;
+    while (fib[k] < num_values + 1) {
+        k++;
+        fib[k] = fib[k-1] + fib[k-2];
     }
 
-    rtune_var_update_kind_t update_lt;
-    rtune_var_update_kind_t update_policy;
-    int update_iteration_start;
-    int batch_size;
-    int update_iteration_stride;
-    int batch_index;
-
-    //process each variable
-    int i;
-    for (i=0; i<region->num_vars; i++) {
-        rtune_var_t *var = &region->vars[i];
-        if (var->status >= RTUNE_STATUS_UPDATE_COMPLETE) continue; //update is complete or retired
-        //if (var->status >= RTUNE_STATUS_RETIRED) continue; //no more updated needed
-
-        stvar_t * stvar = &var->stvar;
-        update_lt = var->update_lt;
-        if (update_lt != RTUNE_UPDATE_REGION_BEGIN && update_lt != RTUNE_UPDATE_REGION_BEGIN_END &&
-            update_lt != RTUNE_UPDATE_REGION_BEGIN_END_DIFF)
-            continue;
-
-        //Check whether this is the iteration for the update based on the schedule
-        update_iteration_start = var->update_iteration_start;
-        batch_index = count - update_iteration_start;
-        if (batch_index < 0) continue; //not its turn, the var-status should be RTUNE_STATUS_CREATED
-        else if (batch_index == 0) { //It is for this var's turn
-            //the setting of enabling a variable update is solely determined by the update_iteration_start. Thus if a function
-            //has two more more variables, they need to be updated one by one. Their schedules should NOT overlap, see rtune_func_schedule_check func
-            var->status = RTUNE_STATUS_SAMPLING;
-        }
-
-        batch_size = var->batch_size;
-        update_iteration_stride = var->update_iteration_stride;
-        batch_index = batch_index % (batch_size + update_iteration_stride);
-        if (batch_index > batch_size) {
-            //in the stride, skip
-            continue; //No need to update this var since it is not its turn stvar on
-        }
-
-        rtune_kind_t kind = var->kind;
-        update_policy = var->update_policy;
-
-        int index = -1; //the index to access the state of the new var of the variable
-
-        switch (kind) {
-            case RTUNE_VAR_LIST:
-            case RTUNE_VAR_RANGE: {
-                if (batch_index == 0) {
-                    index = rtune_var_update_list_range(var);
-                    //rtune_var_print_list_range(var, count);
-                }
-                break;
-            }
-            case RTUNE_VAR_EXT:
-                index = rtune_stvar_ext_update_begin(stvar, update_policy, batch_index, batch_size);
-                break;
-#if USING_VAR_EXT_DIFF_IS_USEFUL
-            case RTUNE_VAR_EXT_DIFF: {
-                rtune_stvar_ext_diff_update_begin(stvar, update_policy, batch_index);
-                break;
+    int lo = -1;
+    while (k > 3) {
+        int points[2] = {lo + fib[k-2], lo + fib[k-1]};
+        double f[2];
+        int u;
+        for (u = 0; u < 2; u++) {
+            if (points[u] >= num_values) {
+                f[u] = maximize ? -HUGE_VAL : HUGE_VAL;
+                continue;
             }
-#endif
-            default:
-                break;
-        }
-        if (index >=0 ) { //update this config in the config and apply this var config
-            rtune_var_apply(var, index, count);
-            if (stvar->total_num_states == stvar->num_states) {//update completed and this is last iteration of the last batch.
-            	var->status = RTUNE_STATUS_UPDATE_COMPLETE;
-            	//rtune_var_print_list_range(var, count);
+            int state = rtune_func_state_of_value(func, var, points[u]);
+            if (state < 0) {
+                var->proposed_v_index = points[u];
+                printf("golden section of func %s brackets the %s in %s[%d, %d], sampling [%d]\n", func->stvar.name,
+                       maximize ? "max" : "min", var->stvar.name, lo + 1, lo + fib[k] - 1 < num_values ? lo + fib[k] - 1 : num_values - 1, points[u]);
+                return -1;
             }
+            f[u] = rtune_column_double(func_values, state);
         }
+        if (!(maximize ? f[0] >= f[1] : f[0] <= f[1])) lo = points[0]; //the optimum is in (lo+F(k-2), lo+F(k))
+        k--; //otherwise in (lo, lo+F(k-1))
     }
 
-    //update the states of the function that needs to be modeled if the function is in the state of sampling
-    //var->func usage dependency forms a tree/graph data structure, but most cases two-level tree. Right now, we only consider var->func two level dependency
-    // For an arbitrary tree, we need to traverse this tree to update each unmodeled function. Depth-first algorithm should be used since in
-    // the situation that an unmodeled funcs depends on more than one variables, the function should be updated according
-    // to one variable first, and then the other.
-    for (i = 0; i < region->num_funcs; i++) {
-        rtune_func_t *func = &region->funcs[i];
-        if (func->status >= RTUNE_STATUS_UPDATE_COMPLETE) continue; //no more updated needed
-
-        rtune_var_t * avar = NULL;
-        if (func->num_vars > 0) {
-            //check the variables to see which one is used to follow the schedule if the func's schedule is not set
-            //XXX: right now, at exactly only one variable of the function should be in the sampling stage.
-            int j;
-            avar = func->active_var; //active variable
-            if (avar == NULL || avar->status != RTUNE_STATUS_SAMPLING || avar->status != RTUNE_STATUS_UPDATE_COMPLETE) { //find another active var
-            	avar = NULL;
-                for (j=0; j<func->num_vars; j++) {
-                    rtune_var_t * tmp = func->input_vars[j];
-                    if (tmp->status == RTUNE_STATUS_SAMPLING || tmp->status == RTUNE_STATUS_UPDATE_COMPLETE) {
-                        func->active_var = tmp;
-                        avar = tmp;
-                        break;
-                    }
+    int state = rtune_func_state_of_value(func, var, lo + 1);
+    if (state < 0) var->proposed_v_index = lo + 1;
+    return state;
+}
+
+/**
+ * k-ary gradient search of a unimodal func over a list/range var that follows the objective, k is 2, 4, 8 or 16 for the
+ * BINARY, QUATERNARY, OCTAL and HEX_GRADIENT strategies. The bracket [lo, hi] of the values is split into k segments by
+ * k-1 points, and the gradient at a point m is from the func at m to the func at m+h. The step h is 1/(2k) of the
+ * bracket, not the next value, so the gradient of a noisy func is not lost in the noise while the bracket is wide. For
+ * the min, the first point whose gradient is not negative closes the bracket to its segment extended by h-1 values, and
+ * the segment after the last point is the bracket if the gradients are all negative (the other way around for the max).
+ * The gradients are checked in the order of the points, and the points after the one that closes the bracket are not
+ * sampled. The bracket is at most 3/(2k) of the values after each round, so the number of samples is at most 2(k-1) per
+ * round for about log_{2k/3}(n) rounds. The search is replayed from the whole list/range on each evaluation with the sampled values as
+ * rtune_objective_golden_section_1var does, and the first value that is not sampled yet is proposed.
+ * @return the index of the state of the func at the optimum once the bracket is one or two values, -1 if a value is proposed
+ */
+static int rtune_objective_gradient_1var(rtune_objective_t *obj, int k, int maximize) {
+    rtune_func_t *func = obj->input_funcs[0].func;
+    rtune_var_t *var = func->input_vars[0];
+    rtune_column_t func_values = rtune_func_column_value(func);
+    int lo = 0;
+    int hi = var->num_unique_values - 1;
+    int rounds = 0;
+    int j, u;
+
+    while (hi - lo + 1 > 2) {
+        int width = hi - lo + 1;
+        int num_segments = k < width - 1 ? k : width - 1;
+        int step = width / (2 * k) > 1 ? width / (2 * k) : 1;
+        int next_lo = -1;
+        int next_hi = hi;
+        for (j = 1; j < num_segments && next_lo < 0; j++) {
+            int m = lo + width * j / num_segments - 1;
+            int points[2] = {m, m + step};
+            double f[2];
+            for (u = 0; u < 2; u++) {
+                int state = rtune_func_state_of_value(func, var, points[u]);
+                if (state < 0) {
+                    var->proposed_v_index = points[u];
+                    printf("%d-ary gradient search of func %s brackets the %s in %s[%d, %d] in round %d, sampling [%d]\n", k,
+                           func->stvar.name, maximize ? "max" : "min", var->stvar.name, lo, hi, rounds, points[u]);
+                    return -1;
                 }
-                if (avar == NULL) { func->active_var = NULL; }
+                f[u] = rtune_column_double(func_values, state);
+            }
+            double gradient = f[1] - f[0];
+            if (maximize ? gradient <= 0 : gradient >= 0) {
+                next_lo = lo + width * (j - 1) / num_segments; //the segment that ends at the point
+                next_hi = m + step - 1;
             }
         }
+        if (next_lo < 0) next_lo = lo + width * (num_segments - 1) / num_segments; //after the last point
+        lo = next_lo;
+        hi = next_hi;
+        rounds++;
+    }
 
-        if (func->update_lt == RTUNE_DEFAULT_NONE && avar != NULL)
-            update_lt = avar->update_lt;
-        else update_lt = func->update_lt;
-
-        if (update_lt != RTUNE_UPDATE_REGION_BEGIN && update_lt != RTUNE_UPDATE_REGION_BEGIN_END &&
-            update_lt != RTUNE_UPDATE_REGION_BEGIN_END_DIFF)
-            continue;
-
-        if (func->update_policy == RTUNE_DEFAULT_NONE && avar != NULL)
-            update_policy = avar->update_policy;
-        else update_policy = func->update_policy;
-
-        if (func->update_iteration_start == RTUNE_DEFAULT_NONE && avar != NULL)
-            update_iteration_start = avar->update_iteration_start;
-        else update_iteration_start = func->update_iteration_start;
-
-        batch_index = count - update_iteration_start;
-        if (batch_index < 0) continue;
-        else if (batch_index == 0) {
-            func->status = RTUNE_STATUS_SAMPLING;
+    int best = -1;
+    for (j = lo; j <= hi; j++) {
+        int state = rtune_func_state_of_value(func, var, j);
+        if (state < 0) {
+            var->proposed_v_index = j;
+            return -1;
         }
+        if (best < 0 || (maximize ? rtune_column_double(func_values, state) > rtune_column_double(func_values, best)
+                                  : rtune_column_double(func_values, state) < rtune_column_double(func_values, best))) best = state;
+    }
+    return best;
+}
 
-        if (func->batch_size == RTUNE_DEFAULT_NONE && avar != NULL)
-            batch_size = avar->batch_size;
-        else batch_size = func->batch_size;
-
-        if (func->update_iteration_stride == RTUNE_DEFAULT_NONE && avar != NULL)
-            update_iteration_stride = avar->update_iteration_stride;
-        else update_iteration_stride = func->update_iteration_stride;
+/**
+ * the state of the min (or the max) of all the states of a func, i.e. the best config sampled by a search over all its vars
+ */
+static int rtune_func_best_state(rtune_func_t *func, int maximize) {
+    utype_t value;
+    if (maximize) {
+        set_min(&value, func->stvar.type);
+        return rtune_stvar_find_max(&func->stvar, 0, func->stvar.num_states, &value);
+    }
+    set_max(&value, func->stvar.type);
+    return rtune_stvar_find_min(&func->stvar, 0, func->stvar.num_states, &value);
+}
 
-        batch_index = batch_index % (batch_size + update_iteration_stride);
+#define RTUNE_NELDER_MEAD_MAX_VARS RTUNE_DESIGN_MAX_DIMS
+#define RTUNE_NELDER_MEAD_MAX_ITERATIONS 64 //for each var, the search also stops when it runs out of its sample budget
 
-        if (batch_index > batch_size) {
-            //in the stride, skip
-            continue; //No need to update this var since it is not its turn stvar on
-        }
+/**
+ * the sample budget of the Nelder-Mead search of a func, see DEFAULT_nelder_mead_samples_per_var
+ */
+static int rtune_nelder_mead_budget(rtune_func_t *func) {
+    int budget = DEFAULT_nelder_mead_samples_per_var * func->num_vars;
+    return budget < func->stvar.total_num_states ? budget : func->stvar.total_num_states;
+}
 
-        stvar_t * stvar = &func->stvar;
-        int index = -1;
-        switch (func->kind) {
-            case RTUNE_FUNC_EXT:
-                index = rtune_stvar_ext_update_begin(&func->stvar, update_policy, batch_index, batch_size);
-                break;
-            case RTUNE_FUNC_EXT_DIFF:
-                rtune_stvar_ext_diff_update_begin(&func->stvar, update_policy, batch_index);
-                break;
-            default:
-                break;
-        }
+/**
+ * grow the flat trace of a var to hold num_states states, the states that have been recorded are copied
+ * @return 0 on success, -1 if the system runs out of memory
+ */
+static int rtune_var_states_reserve(rtune_var_t *var, int num_states) {
+    stvar_t *stvar = &var->stvar;
+    if (num_states <= stvar->total_num_states || stvar->trace_mode != RTUNE_TRACE_FLAT) return 0;
+    void *states = rtune_arena_alloc(&var->region->arena, stvar->ops->size * num_states);
+    if (states == NULL) return -1;
+    if (stvar->num_states > 0) memcpy(states, stvar->states, stvar->ops->size * stvar->num_states);
+    stvar->states = states;
+    stvar->total_num_states = num_states;
+    return 0;
+}
 
-        if (index >= 0) {//update the input of this new func value
-        	func->unused_updates++;
-            int k;
-            int * input = &func->input[index*func->num_vars]; //input is a 2-D array of int [total_num_states][num_vars]
-            for (k=0; k<func->num_vars; k++) {
-                //The input of the func from the var is always the last state of the var as it is latest update since
-                //the var of a func is only updated one a time (by restricting their schedule to not overlap)
-                input[k] = func->input_vars[k]->stvar.num_states - 1;
-            }
-            if (stvar->total_num_states == stvar->num_states) {//Only for RTUNE_FUNC_EXT
-            	func->status = RTUNE_STATUS_UPDATE_COMPLETE;
-            	rtune_func_print_doubleFunc_intVar(func, count);
-            	//TODO: we might not use total_num_states for condition check
-            }
+/**
+ * the state of a func that is sampled with the config, i.e. the config[j]-th value of each of its list/range vars, the
+ * newest one if the config is sampled more than once
+ * @return the index of the state, -1 if the config is not sampled yet
+ */
+static int rtune_func_state_of_config(rtune_func_t *func, const int *config) {
+    int s, j;
+    for (j = 0; j < func->num_vars; j++) if (func->input_vars[j]->count_value[config[j]] == 0) return -1;
+    for (s = func->stvar.num_states - 1; s >= 0; s--) {
+        int index = rtune_stvar_state_index(&func->stvar, s);
+        for (j = 0; j < func->num_vars; j++) {
+            rtune_var_t *var = func->input_vars[j];
+            if (rtune_var_value_index(var, rtune_column_double(rtune_func_column_var(func, j), index)) != config[j]) break;
         }
+        if (j == func->num_vars) return index;
     }
+    return -1;
 }
 
-void rtune_region_end(rtune_region_t * region) {
-    if (region->status == RTUNE_STATUS_RETIRED) return;
-    int count = region->count;
-    int i;
-    int num_objs = region->num_objs;
-    rtune_objective_t *objs = region->objs;
-    rtune_var_update_kind_t update_lt;
-    rtune_var_update_kind_t update_policy;
-    int update_iteration_start;
-    int batch_size;
-    int update_iteration_stride;
-
-    int batch_index;
-
-    //update the states of the function that needs to be modeled if the function is in the state of sampling
-    //var->func usage dependency forms a tree/graph data structure, but most cases two-level tree. Rigth now, we only consider var->func two level dependency
-    // For an arbitrary tree, we need to traverse this tree to update each unmodeled function. Depth-first algorithm should be used since in
-    // the situation that an unmodeled funcs depends on more than one variables, the function should be updated according
-    // to one variable first, and then the other.
-    for (i = 0; i < region->num_funcs; i++) {
-        rtune_func_t *func = &region->funcs[i];
-        if (func->status == RTUNE_STATUS_RETIRED) continue;
-
-        rtune_var_t * avar = NULL;
-        if (func->num_vars > 0) {
-            //check the variables to see which one is used to follow the schedule if the func's schedule is not set
-            //XXX: right now, at exactly only one variable of the function should be in the sampling stage.
-            int j;
-            avar = func->active_var; //active variable
-            if (avar == NULL || avar->status != RTUNE_STATUS_SAMPLING || avar->status != RTUNE_STATUS_UPDATE_COMPLETE) { //find another active var
-            	avar = NULL;
-                for (j=0; j<func->num_vars; j++) {
-                    rtune_var_t * tmp = func->input_vars[j];
-                    if (tmp->status == RTUNE_STATUS_SAMPLING || tmp->status == RTUNE_STATUS_UPDATE_COMPLETE) {
-                        func->active_var = tmp;
-                        avar = tmp;
-                        break;
-                    }
-                }
-                if (avar == NULL) { func->active_var = NULL; }
-            }
-        }
-
-        if (func->update_lt == RTUNE_DEFAULT_NONE && avar != NULL)
-        	update_lt = avar->update_lt;
-        else update_lt = func->update_lt;
-
-        if (update_lt != RTUNE_UPDATE_REGION_END && update_lt != RTUNE_UPDATE_REGION_BEGIN_END &&
-            update_lt != RTUNE_UPDATE_REGION_BEGIN_END_DIFF)
-            continue;
-
-        if (func->update_policy == RTUNE_DEFAULT_NONE && avar != NULL)
-        	update_policy = avar->update_policy;
-        else update_policy = func->update_policy;
-
-        if (func->update_iteration_start == RTUNE_DEFAULT_NONE && avar != NULL)
-        	update_iteration_start = avar->update_iteration_start;
-        else update_iteration_start = func->update_iteration_start;
-
-        batch_index = count - update_iteration_start;
-        if (batch_index < 0) continue;
-        else if (batch_index == 0) {
-            if (update_lt == RTUNE_UPDATE_REGION_END) func->status = RTUNE_STATUS_SAMPLING;
+/**
+ * the func at a point of the Nelder-Mead simplex, which is snapped to the nearest config of the grids of the list/range
+ * vars and negated for the max so the simplex always goes to the min. The point is clamped into the grids first.
+ * @return 0 if the config is sampled, otherwise the config is proposed for all the vars and -1 is returned
+ */
+static int rtune_nelder_mead_eval(rtune_func_t *func, double *x, int maximize, double *f, int *state) {
+    int config[RTUNE_NELDER_MEAD_MAX_VARS];
+    int j;
+    for (j = 0; j < func->num_vars; j++) {
+        double hi = func->input_vars[j]->num_unique_values - 1;
+        if (x[j] < 0.0) x[j] = 0.0;
+        if (x[j] > hi) x[j] = hi;
+        config[j] = (int) lround(x[j]);
+    }
+    *state = rtune_func_state_of_config(func, config);
+    if (*state < 0) {
+        printf("nelder-mead of func %s samples the config [", func->stvar.name);
+        for (j = 0; j < func->num_vars; j++) {
+            func->input_vars[j]->proposed_v_index = config[j];
+            printf("%s%s:%d", j > 0 ? ", " : "", func->input_vars[j]->stvar.name, config[j]);
         }
+        printf("]\n");
+        return -1;
+    }
+    *f = rtune_column_double(rtune_func_column_value(func), *state);
+    if (maximize) *f = -*f;
+    return 0;
+}
 
-        if (func->batch_size == RTUNE_DEFAULT_NONE && avar != NULL) batch_size = avar->batch_size;
-        else batch_size = func->batch_size;
-        if (func->update_iteration_stride == RTUNE_DEFAULT_NONE)
-            update_iteration_stride = avar->update_iteration_stride;
-        else update_iteration_stride = func->update_iteration_stride;
+/**
+ * the index of the value of the j-th var of the func nearest to x, clamped into the grid of the var
+ */
+static int rtune_nelder_mead_snap(rtune_func_t *func, int j, double x) {
+    int hi = func->input_vars[j]->num_unique_values - 1;
+    int v = (int) lround(x);
+    return v < 0 ? 0 : (v > hi ? hi : v);
+}
 
-        batch_index = batch_index % (batch_size + update_iteration_stride);
-        if (batch_index > batch_size) {
-            //in the stride, skip
-            continue; //No need to update this var since it is not its turn stvar on
+/**
+ * whether the i-th point of the simplex snaps to the same config as another of the first n points
+ */
+static int rtune_nelder_mead_collides(rtune_func_t *func, double simplex[][RTUNE_NELDER_MEAD_MAX_VARS], int i, int n) {
+    int j, k;
+    for (k = 0; k < n; k++) {
+        if (k == i) continue;
+        for (j = 0; j < func->num_vars; j++) {
+            if (rtune_nelder_mead_snap(func, j, simplex[i][j]) != rtune_nelder_mead_snap(func, j, simplex[k][j])) break;
         }
+        if (j == func->num_vars) return 1;
+    }
+    return 0;
+}
 
-        stvar_t *stvar = &func->stvar;
-        int index = -1;
-        switch (func->kind) {
-            case RTUNE_FUNC_EXT:
-                index = rtune_stvar_ext_update_end(&func->stvar, update_policy, batch_index, batch_size);
-                break;
-            case RTUNE_FUNC_EXT_DIFF:
-                index = rtune_stvar_ext_diff_update_end(&func->stvar, update_policy, batch_index, batch_size);
-                break;
-            default:
-                break;
+/**
+ * move the i-th point of the simplex by one index on an axis, its own axis first, if it snaps to the same config as another
+ * of the first n points, so the points are sampled as distinct configs, e.g. both points of a var of 2 values
+ */
+static void rtune_nelder_mead_separate(rtune_func_t *func, double simplex[][RTUNE_NELDER_MEAD_MAX_VARS], int i, int n) {
+    int d = func->num_vars;
+    int t, delta;
+    if (!rtune_nelder_mead_collides(func, simplex, i, n)) return;
+    for (t = 0; t < d; t++) {
+        int a = (i + d - 1 + t) % d;
+        double saved = simplex[i][a];
+        for (delta = 1; delta >= -1; delta -= 2) {
+            int v = rtune_nelder_mead_snap(func, a, saved) + delta;
+            if (v < 0 || v >= func->input_vars[a]->num_unique_values) continue;
+            simplex[i][a] = v;
+            if (!rtune_nelder_mead_collides(func, simplex, i, n)) return;
         }
+        simplex[i][a] = saved;
+    }
+}
 
-        if (index >= 0) {//update the input of this new func value
-        	func->unused_updates++;
-            int *input = &func->input[index * func->num_vars]; //input is a 2-D array of int [total_num_states][num_vars]
-            int j;
-            for (j = 0; j < func->num_vars; j++) {
-                //The input of the func from the var is always the last state of the var as it is latest update since
-                //the var of a func is only updated one a time (by restricting their schedule to not overlap)
-                input[j] = func->input_vars[j]->stvar.num_states - 1;
-            }
-
-            if (stvar->total_num_states == stvar->num_states) {//update completed at the beginning of the last batch
-                func->status = RTUNE_STATUS_UPDATE_COMPLETE;
-                rtune_func_print_doubleFunc_intVar(func, count);
-                //TODO: we might not use total_num_states for condition check
+/**
+ * the best config around the point the simplex converges to: the unsampled neighbours (one index away on each axis) of
+ * the best config are sampled, and the search moves to the best neighbour until no neighbour is better, so the
+ * search does not stop next to the optimum because the simplex is snapped to the grids.
+ * @return the index of the state of the best config, -1 if a neighbour is proposed
+ */
+static int rtune_nelder_mead_polish(rtune_func_t *func, const double *x, int maximize, int state) {
+    int d = func->num_vars;
+    int config[RTUNE_NELDER_MEAD_MAX_VARS];
+    double p[RTUNE_NELDER_MEAD_MAX_VARS];
+    int j, delta;
+    for (j = 0; j < d; j++) config[j] = rtune_nelder_mead_snap(func, j, x[j]);
+    double f = rtune_column_double(rtune_func_column_value(func), state);
+    if (maximize) f = -f;
+    while (1) {
+        int best = state, best_j = -1, best_delta = 0;
+        double best_f = f;
+        for (j = 0; j < d; j++) {
+            for (delta = -1; delta <= 1; delta += 2) {
+                int v = config[j] + delta;
+                if (v < 0 || v >= func->input_vars[j]->num_unique_values) continue;
+                int k;
+                double fn;
+                int sn;
+                for (k = 0; k < d; k++) p[k] = config[k];
+                p[j] = v;
+                if (rtune_nelder_mead_eval(func, p, maximize, &fn, &sn) < 0) return -1;
+                if (fn < best_f) {
+                    best = sn;
+                    best_f = fn;
+                    best_j = j;
+                    best_delta = delta;
+                }
             }
         }
+        if (best_j < 0) return state;
+        config[best_j] += best_delta;
+        state = best;
+        f = best_f;
     }
+}
 
-    //check objective to see whether anyone is met. An objective is only check when its objective func is complete,
-    //which is complete only if the variable have all the values for the func
-    for (i = 0; i < num_objs; i++) {
-        rtune_objective_t *obj = &objs[i];
-        if (obj->status == RTUNE_STATUS_RETIRED) continue;
-        int j;
-        int num_updated_funcs = 0;
-        for (j=0; j<obj->num_funcs; j++) { //Check to see whether it needs to check the objective in this iteration by checking whether a func is updated or not
-        	rtune_func_t *func = obj->input_funcs[j].func;
-        	if (func->unused_updates) {
-        		num_updated_funcs ++;
-        	}
-        }
-        if (num_updated_funcs == 0) continue; //No func has been updated this time, no need to evaluate objectives
-
-        switch (obj->kind) {
-            case RTUNE_OBJECTIVE_MIN: {
-                //printf("Evaluating min threshold ...: ");
-                //int index = rtune_objective_evaluate_min(obj);
-                //int var_index = obj->input_funcs[0].func->input[index];
-                //if (index >= 0)
-                //    printf("min objective is met: index: %d, var: %d, func: %.2f\n", index,
-                //           ((short *) (obj->input_funcs[0].func->input_vars[0]->stvar.states))[var_index],
-                //           ((double *) (obj->input_funcs[0].func->stvar.states))[index]);
-
-                rtune_func_t *func = obj->input_funcs[0].func;
-                rtune_var_t * var = func->input_vars[0]; //This should be the same as obj->config[0].var;
-                int index = -1;
-                int var_index = -1;
-
-                if (obj->search_strategy == RTUNE_OBJECTIVE_SEARCH_UNIMODAL_ON_THE_FLY) {
-                	if (func->stvar.num_states < obj->lookup_window) continue;
-                    printf("########## Evaluating min objective with unimodal on the fly ...: ##################################\n");
-                    printf("########## Lookup Window: %d, Fidelity Window: %d ###############################################\n",
-                           obj->lookup_window, obj->fidelity_window);
-                    rtune_func_print_doubleFunc_intVar(func, count);
-                    index = rtune_objective_min_unimodal_gradient_1var(obj);
-                    func->unused_updates = 0;
-                    if (index >= 0) {
-                        obj->status = RTUNE_STATUS_OBJECTIVE_MET;
-                        var_index = func->input[index];
-                        printf("min objective is met: index: %d, var: %d, func: %.2f\n", index,
-                        		rtune_var_get_value(var, var_index)._short_value, rtune_func_get_value(func, index)._double_value);
-                    	//apply the variable configuration for the objective that is just met
-                    	obj->input_vars[0].value = rtune_var_apply(var, var_index, count);
-                    	obj->input_vars[0].var = var;
-                    	obj->input_vars[0].index = var_index;
-                    	obj->input_vars[0].preference_right = 1;
-                    	obj->input_vars[0].last_iteration_applied = count;
-
-                    	obj->input_funcs[0].index = index;
-                    	obj->input_funcs[0].value = rtune_func_get_value(func, index);
-
-                    	//call the callback of the objective
-                    	if (obj->callback != NULL) obj->callback(obj, obj->callback_arg);
-                    }
-                    printf("######################################################################################################\n");
-                } else if (obj->search_strategy == RTUNE_OBJECTIVE_SEARCH_EXHAUSTIVE_AFTER_COMPLETE) {
-                    if (func->status != RTUNE_STATUS_UPDATE_COMPLETE ) continue;
-                    printf("####### Evaluating min objective with exhaustive search after sampling complete ...: #######\n");
-                    //index = rtune_objective_evaluate_min_exhaustive_after_complete(obj);
-                    utype_t *minValue = &(obj->input_funcs[0].value); //For getting the current min value
-                    index = rtune_stvar_find_min(&(func->stvar), 0, func->stvar.num_states, minValue);
-                    obj->status = RTUNE_STATUS_OBJECTIVE_MET;
-                    func->unused_updates = 0;
-                    if (index >= 0) {
-                    	var_index = func->input[index];
-                        printf("min objective is met: index: %d, var: %d, func: %.2f\n", index,
-                        		rtune_var_get_value(var, var_index)._short_value, rtune_func_get_value(func, index)._double_value);
-                    }
-                	//apply the variable configuration for the objective that is just met
-                	obj->input_vars[0].value = rtune_var_apply(var, var_index, count);
-                	obj->input_vars[0].var = var;
-                	obj->input_vars[0].index = var_index;
-                	obj->input_vars[0].preference_right = 1;
-                	obj->input_vars[0].last_iteration_applied = count;
-
-                	obj->input_funcs[0].index = index;
-                   	obj->input_funcs[0].value = rtune_func_get_value(func, index);
+/**
+ * Nelder-Mead simplex search of a func over all its list/range vars, whose configs are proposed to the vars together
+ * (see rtune_objective_nelder_mead_setup). The simplex is in the space of the indices of the values of the vars, it
+ * starts at the center of the grids with a step of a quarter of each grid, and the points are snapped to the grids to be
+ * sampled. A point that snaps to the same config as another one is moved to a distinct config. The standard reflection
+ * (1), expansion (2), contraction (1/2) and shrink (1/2) steps are taken until all the points of the simplex are snapped
+ * to the same or adjacent configs, or the search runs out of its iterations or its sample budget (see
+ * rtune_nelder_mead_budget). The neighbours of the best point are then sampled (see rtune_nelder_mead_polish). As the searches over a single var, the search is replayed from the
+ * initial simplex on each evaluation with the sampled configs, and the first config that is not sampled yet is proposed.
+ * @return the index of the state of the func at the best point once the search converges, -1 if a config is proposed
+ */
+static int rtune_objective_nelder_mead(rtune_objective_t *obj, int maximize) {
+    rtune_func_t *func = obj->input_funcs[0].func;
+    int d = func->num_vars;
+    double simplex[RTUNE_NELDER_MEAD_MAX_VARS + 1][RTUNE_NELDER_MEAD_MAX_VARS];
+    double f[RTUNE_NELDER_MEAD_MAX_VARS + 1];
+    int states[RTUNE_NELDER_MEAD_MAX_VARS + 1];
+    double centroid[RTUNE_NELDER_MEAD_MAX_VARS], r[RTUNE_NELDER_MEAD_MAX_VARS], e[RTUNE_NELDER_MEAD_MAX_VARS];
+    double fr, fe;
+    int sr, se;
+    int i, j, iteration;
+    if (d == 0 || d > RTUNE_NELDER_MEAD_MAX_VARS) return -1;
+
+    if (func->stvar.num_states >= rtune_nelder_mead_budget(func)) return rtune_func_best_state(func, maximize); //out of budget
+
+    for (i = 0; i <= d; i++) {
+        for (j = 0; j < d; j++) {
+            double hi = func->input_vars[j]->num_unique_values - 1;
+            simplex[i][j] = hi / 2.0;
+            if (i == j + 1) simplex[i][j] += hi / 4.0 > 1.0 ? hi / 4.0 : 1.0;
+        }
+        rtune_nelder_mead_separate(func, simplex, i, i);
+        if (rtune_nelder_mead_eval(func, simplex[i], maximize, &f[i], &states[i]) < 0) return -1;
+    }
 
-                	//call the callback of the objective
-                	if (obj->callback != NULL) obj->callback(obj, obj->callback_arg);
-                    printf("######################################################################################################\n");
-                } else if (obj->search_strategy == RTUNE_OBJECTIVE_SEARCH_EXHAUSTIVE_ON_THE_FLY) {
-                    printf("##### Evaluating min objective with exhaustive search on the fly ...: ########\n");
-                    utype_t *minValue = &(obj->input_funcs[0].value); //For getting the current min value
-                    index = rtune_stvar_find_min(&(func->stvar), func->stvar.num_states-1, 1, minValue);
-                    func->unused_updates = 0;
-                    //index = rtune_objective_evaluate_min_exhaustive_on_the_fly(obj, minValue);
-                    if (index >= 0) { //Here we store the temp min in the config and input_funcs
-                    	obj->input_funcs[0].index = index;
-                    	var_index = func->input[index];
-                    	obj->input_vars[0].value = rtune_var_get_value(var, var_index);
-                    	obj->input_vars[0].index = var_index;
-                    	obj->input_vars[0].var = var;
-                    	obj->input_vars[0].preference_right = 1;
-                    	//obj->config[0].last_iteration_applied = count;
-
-                    	printf("min objective is met: index: %d, var: %d, func: %.2f\n", index,
-                        		rtune_var_get_value(var, var_index)._short_value, obj->input_funcs[0].value._double_value);
-                    }
-                    if (func->status == RTUNE_STATUS_UPDATE_COMPLETE) {
-                        obj->status = RTUNE_STATUS_OBJECTIVE_MET;
-                        var_index = obj->input_vars[0].index;
-                    	rtune_var_apply(var, var_index, count);
-                    	obj->input_vars[0].last_iteration_applied = count;
-                    	//apply the variable configuration for the objective that is just met
-
-
-                    	//call the callback of the objective
-                    	if (obj->callback != NULL) obj->callback(obj, obj->callback_arg);
-                    }
-                    printf("######################################################################################################\n");
-                } else {
-                	//unsupported min search strategy
-                	printf("unsupported min search strategy\n");
+    for (iteration = 0; iteration < RTUNE_NELDER_MEAD_MAX_ITERATIONS * d; iteration++) {
+        for (i = 1; i <= d; i++) { //order the points from the best to the worst
+            int k = i;
+            while (k > 0 && f[k] < f[k-1]) {
+                double t = f[k]; f[k] = f[k-1]; f[k-1] = t;
+                int ts = states[k]; states[k] = states[k-1]; states[k-1] = ts;
+                for (j = 0; j < d; j++) {
+                    t = simplex[k][j]; simplex[k][j] = simplex[k-1][j]; simplex[k-1][j] = t;
                 }
-                break;
+                k--;
             }
-            case RTUNE_OBJECTIVE_MAX: {
-                rtune_func_t *func = obj->input_funcs[0].func;
-                rtune_var_t * var = func->input_vars[0]; //This should be the same as obj->config[0].var;
-                int index = -1;
-                int var_index = -1;
-
-                if (obj->search_strategy == RTUNE_OBJECTIVE_SEARCH_UNIMODAL_ON_THE_FLY) {
-                	if (func->stvar.num_states < obj->lookup_window) continue;
-                    printf("########## Evaluating max objective with unimodal on the fly ...: ##################################\n");
-                    printf("########## Lookup Window: %d, Fidelity Window: %d ###############################################\n",
-                           obj->lookup_window, obj->fidelity_window);
-                    rtune_func_print_doubleFunc_intVar(func, count);
-                    index = rtune_objective_max_unimodal_gradient_1var(obj);
-                    func->unused_updates = 0;
-                    if (index >= 0) {
-                        obj->status = RTUNE_STATUS_OBJECTIVE_MET;
-                        var_index = func->input[index];
-                        printf("max objective is met: index: %d, var: %d, func: %.2f\n", index,
-                        		rtune_var_get_value(var, var_index)._short_value, rtune_func_get_value(func, index)._double_value);
-                    	//apply the variable configuration for the objective that is just met
-                    	obj->input_vars[0].value = rtune_var_apply(var, var_index, count);
-                    	obj->input_vars[0].var = var;
-                    	obj->input_vars[0].index = var_index;
-                    	obj->input_vars[0].preference_right = 1;
-                    	obj->input_vars[0].last_iteration_applied = count;
-
-                    	obj->input_funcs[0].index = index;
-                    	obj->input_funcs[0].value = rtune_func_get_value(func, index);
-
-                    	//call the callback of the objective
-                    	if (obj->callback != NULL) obj->callback(obj, obj->callback_arg);
-                    }
-                    printf("######################################################################################################\n");
-                } else if (obj->search_strategy == RTUNE_OBJECTIVE_SEARCH_EXHAUSTIVE_AFTER_COMPLETE) {
-                    if (func->status != RTUNE_STATUS_UPDATE_COMPLETE)  continue;
-                    printf("####### Evaluating max objective with exhaustive search after sampling complete ...: #######\n");
-                    //index = rtune_objective_evaluate_min_exhaustive_after_complete(obj);
-                    utype_t *maxValue = &(obj->input_funcs[0].value); //For getting the current max value
-                    index = rtune_stvar_find_max(&(func->stvar), 0, func->stvar.num_states, maxValue);
-                    func->unused_updates = 0;
-                    obj->status = RTUNE_STATUS_OBJECTIVE_MET;
-                    if (index >= 0) {
-                    	var_index = func->input[index];
-                        printf("max objective is met: index: %d, var: %d, func: %.2f\n", index,
-                        		rtune_var_get_value(var, var_index)._short_value, rtune_func_get_value(func, index)._double_value);
-                    }
-                	//apply the variable configuration for the objective that is just met
-                	obj->input_vars[0].value = rtune_var_apply(var, var_index, count);
-                	obj->input_vars[0].var = var;
-                	obj->input_vars[0].index = var_index;
-                	obj->input_vars[0].preference_right = 1;
-                	obj->input_vars[0].last_iteration_applied = count;
-
-                	obj->input_funcs[0].index = index;
-                   	obj->input_funcs[0].value = rtune_func_get_value(func, index);
+        }
+        int converged = 1;
+        for (i = 1; i <= d && converged; i++) {
+            for (j = 0; j < d; j++) {
+                if (labs(lround(simplex[i][j]) - lround(simplex[0][j])) > 1) converged = 0;
+            }
+        }
+        if (converged) break;
 
-                	//call the callback of the objective
-                	if (obj->callback != NULL) obj->callback(obj, obj->callback_arg);
-                    printf("######################################################################################################\n");
-                } else if (obj->search_strategy == RTUNE_OBJECTIVE_SEARCH_EXHAUSTIVE_ON_THE_FLY) {
-                    printf("##### Evaluating max objective with exhaustive search on the fly ...: ########\n");
-                    utype_t *maxValue = &(obj->input_funcs[0].value); //For getting the current max value
-                    index = rtune_stvar_find_max(&(func->stvar), func->stvar.num_states-1, 1, maxValue);
-                    func->unused_updates = 0;
-                    //index = rtune_objective_evaluate_min_exhaustive_on_the_fly(obj, minValue);
-                    if (index >= 0) { //Here we store the temp max in the config and input_funcs
-                    	obj->input_funcs[0].index = index;
-                    	var_index = func->input[index];
-                    	obj->input_vars[0].value = rtune_var_get_value(var, var_index);
-                    	obj->input_vars[0].index = var_index;
-                    	obj->input_vars[0].var = var;
-                    	obj->input_vars[0].preference_right = 1;
-                    	//obj->config[0].last_iteration_applied = count;
-
-                    	printf("min objective is met: index: %d, var: %d, func: %.2f\n", index,
-                        		rtune_var_get_value(var, var_index)._short_value, obj->input_funcs[0].value._double_value);
-                    }
-                    if (func->status == RTUNE_STATUS_UPDATE_COMPLETE) {
-                        obj->status = RTUNE_STATUS_OBJECTIVE_MET;
-                        var_index = obj->input_vars[0].index;
-                    	rtune_var_apply(var, var_index, count);
-                    	obj->input_vars[0].last_iteration_applied = count;
-                    	//apply the variable configuration for the objective that is just met
-                    	//call the callback of the objective
-                    	if (obj->callback != NULL) obj->callback(obj, obj->callback_arg);
-                    }
-                    printf("######################################################################################################\n");
-                } else {
-                	printf("unsupported max search strategy\n");
+        for (j = 0; j < d; j++) {
+            centroid[j] = 0.0;
+            for (i = 0; i < d; i++) centroid[j] += simplex[i][j] / d;
+            r[j] = centroid[j] + (centroid[j] - simplex[d][j]);
+        }
+        if (rtune_nelder_mead_eval(func, r, maximize, &fr, &sr) < 0) return -1;
+        if (fr < f[0]) { //expand
+            for (j = 0; j < d; j++) e[j] = centroid[j] + 2.0 * (r[j] - centroid[j]);
+            if (rtune_nelder_mead_eval(func, e, maximize, &fe, &se) < 0) return -1;
+            if (fe < fr) {
+                memcpy(r, e, sizeof(double) * d);
+                fr = fe;
+                sr = se;
+            }
+        } else if (fr >= f[d-1]) { //contract, outside the simplex if the reflection is better than the worst
+            int outside = fr < f[d];
+            for (j = 0; j < d; j++) e[j] = centroid[j] + 0.5 * ((outside ? r[j] : simplex[d][j]) - centroid[j]);
+            if (rtune_nelder_mead_eval(func, e, maximize, &fe, &se) < 0) return -1;
+            if (fe < (outside ? fr : f[d])) {
+                memcpy(r, e, sizeof(double) * d);
+                fr = fe;
+                sr = se;
+            } else { //shrink toward the best
+                for (i = 1; i <= d; i++) {
+                    for (j = 0; j < d; j++) simplex[i][j] = simplex[0][j] + 0.5 * (simplex[i][j] - simplex[0][j]);
+                    rtune_nelder_mead_separate(func, simplex, i, d + 1);
+                    if (rtune_nelder_mead_eval(func, simplex[i], maximize, &f[i], &states[i]) < 0) return -1;
                 }
-                break;
+                continue;
             }
-            case RTUNE_OBJECTIVE_INTERSECTION:
-                break;
-            case RTUNE_OBJECTIVE_THRESHOLD_DOWN:
-                break;
-            case RTUNE_OBJECTIVE_THRESHOLD_UP:
-                break;
-            case RTUNE_OBJECTIVE_SELECT_MIN:
-                break;
-            case RTUNE_OBJECTIVE_SEELCT_MAX:
-                break;
-            case RTUNE_OBJECTIVE_THRESHOLD:
-                break;
-            default:
-                break;
         }
+        memcpy(simplex[d], r, sizeof(double) * d); //replace the worst
+        f[d] = fr;
+        states[d] = sr;
     }
+    int best = 0;
+    for (i = 1; i <= d; i++) if (f[i] < f[best]) best = i; //the points are not ordered if the iterations run out
+    return rtune_nelder_mead_polish(func, simplex[best], maximize, states[best]);
+}
 
-    //At this point, all the objectives that are met are applied and in action. TODO: we should apply config/reset action here
-    int num_mets = 0;
-    for (i = 0; i < num_objs; i++) {
-        rtune_objective_t *obj = &objs[i];
-        if (obj->status == RTUNE_STATUS_OBJECTIVE_MET) {
-        	obj->num_mets++; num_mets++;
-        	switch (obj->metaction) {
-        		case RTUNE_METACTION_RESET:
-        			rtune_objective_reset(obj); //TODO: should we do deep reset or just shallow reset
-        			obj->status = RTUNE_STATUS_RESETTED;
-        			break;
-        		default:
-        			break;
-        	}
-        	if (obj->num_mets == obj->max_num_mets) {
-        		obj->status = RTUNE_STATUS_RETIRED; //No need this objective anymore
-        		region->num_retired_objs ++;
-        		if (region->num_retired_objs == region->num_objs) { //when all objectives are retired, region is retired
-        			region->status = RTUNE_STATUS_RETIRED;
-        		}
-        	}
-
-        	int j;
-        	for (j=0; j<obj->num_funcs; j++) {
-        		rtune_func_t *func = obj->input_funcs[j].func;
-        		switch (obj->input_funcs[j].metaction) {
-        			case RTUNE_METACTION_RESET:  //If we need to reset the func
-        				rtune_func_reset(func);
-        				break;
-        			default:
-        				break;
-        		}
-        	}
-        	for (j=0; j<obj->num_vars; j++) {
-        		rtune_var_t *var = obj->input_vars[j].var;
-        		switch (obj->input_vars[j].metaction) {
-        			case RTUNE_METACTION_RESET:
-        				rtune_var_reset(var);
-        				break;
-        			case RTUNE_METACTION_CONFIG:
-        				//apply the applier of the var
-        				break;
-        			case RTUNE_METACTION_CONFIG_RESET:
-        				//apply the applier of the var
-        				rtune_var_reset(var);
-        				break;
-        			default:
-        				break;
-        		}
-        	}
+/**
+ * Set up a search of a func over all its input vars, which must be 1 to RTUNE_DESIGN_MAX_DIMS list/range vars. They follow
+ * the objective and are updated on the schedule of the first var, so the configs the search proposes are applied together
+ * in each batch, and the func is sampled once for each batch with its own schedule. The flat trace of each var is grown to
+ * the sample budget of the search since the vars are sampled for each config.
+ * @return 0 on success, -1 if the vars of the func cannot be searched together
+ */
+static int rtune_func_search_setup(rtune_func_t *func, int budget, const char *search) {
+    int j;
+    if (func->num_vars == 0 || func->num_vars > RTUNE_DESIGN_MAX_DIMS) {
+        printf("%s search of func %s needs 1 to %d vars, it has %d\n", search, func->stvar.name, RTUNE_DESIGN_MAX_DIMS, func->num_vars);
+        return -1;
+    }
+    for (j = 0; j < func->num_vars; j++) {
+        rtune_var_t *var = func->input_vars[j];
+        if (var->kind != RTUNE_VAR_LIST && var->kind != RTUNE_VAR_RANGE) {
+            printf("%s search of func %s needs list/range vars, var %s is not\n", search, func->stvar.name, var->stvar.name);
+            return -1;
         }
     }
 
-    //Here we need to stop updating the var and func if the objectives that use them all meet
-    for (i = 0; i < region->num_funcs; i++) {
-        rtune_func_t *func = &region->funcs[i];
-        if (func->status == RTUNE_STATUS_RETIRED) continue;
-        int j;
-        for (j = 0; j < func->num_objs; j++) {
-            rtune_objective_t *obj = func->objectives[j];
-            if (obj->status != RTUNE_STATUS_RETIRED) break; //check each obj to see whether it is met
-        }
-        if (j == func->num_objs) { //if all objs are retired, var update is complete, set it.
-            func->status = RTUNE_STATUS_RETIRED;
-        }
+    rtune_var_t *first = func->input_vars[0];
+    for (j = 0; j < func->num_vars; j++) {
+        rtune_var_t *var = func->input_vars[j];
+        var->update_policy = RTUNE_UPDATE_LIST_FOLLOW_OBJECTIVE;
+        var->update_lt = first->update_lt;
+        var->update_iteration_start = first->sched_origin + first->update_iteration_start - var->sched_origin;
+        var->batch_size = first->batch_size;
+        var->update_iteration_stride = first->update_iteration_stride;
+        rtune_var_states_reserve(var, budget);
     }
+    if (func->update_iteration_start == RTUNE_DEFAULT_NONE) {
+        func->update_iteration_start = first->sched_origin + first->update_iteration_start - func->sched_origin;
+        if (func->batch_size == RTUNE_DEFAULT_NONE) func->batch_size = first->batch_size;
+        if (func->update_iteration_stride == RTUNE_DEFAULT_NONE) func->update_iteration_stride = first->update_iteration_stride;
+    }
+    rtune_region_mark_dirty(func->region);
+    return 0;
+}
 
-    //process each variable
-    for (i = 0; i < region->num_vars; i++) {
-        rtune_var_t *var = &region->vars[i];
-        if (var->status == RTUNE_STATUS_RETIRED) continue;
-        int j;
-        for (j = 0; j < var->num_uses; j++) {
-            rtune_func_t *func = var->usedByFuncs[j];
-            if (func->status != RTUNE_STATUS_RETIRED) break; //check each obj to see whether it is met
-        }
-        if (j == var->num_uses) { //if all objs are met, var update is complete, set it.
-            var->status = RTUNE_STATUS_RETIRED;
-        }
+/**
+ * The objective falls back to RTUNE_OBJECTIVE_SEARCH_DEFAULT if its search cannot be set up, which otherwise would never
+ * find the optimum.
+ */
+static void rtune_objective_search_fallback(rtune_objective_t *obj) {
+    printf("objective %s falls back to the default search strategy\n", obj->name);
+    obj->search_strategy = RTUNE_OBJECTIVE_SEARCH_DEFAULT;
+}
+
+/**
+ * Set up the Nelder-Mead search of the func of the objective, see rtune_func_search_setup. The first config is proposed
+ * right away, and the objective falls back to the default search if the search cannot be set up.
+ */
+static void rtune_objective_nelder_mead_setup(rtune_objective_t *obj) {
+    rtune_func_t *func = obj->input_funcs[0].func;
+    if (rtune_func_search_setup(func, rtune_nelder_mead_budget(func), "Nelder-Mead") < 0) {
+        rtune_objective_search_fallback(obj);
+        return;
     }
+    rtune_objective_nelder_mead(obj, obj->kind == RTUNE_OBJECTIVE_MAX);
 }
 
-float rtune_calcuate_scalability(rtune_region_t *lgp, int exeTimeVar, int numThreadVar, int problemSizeVar)
-{
+/**
+ * Random search of a func over all its list/range vars: the configs of the design of the objective (see
+ * rtune_objective_random_setup) are proposed one by one, and the best of them is taken once all are sampled. A config that
+ * the design repeats is sampled once.
+ * @return the index of the state of the func at the best config, -1 if a config is proposed
+ */
+static int rtune_objective_random(rtune_objective_t *obj, int maximize) {
+    rtune_func_t *func = obj->input_funcs[0].func;
+    int i, j;
+    if (obj->design_configs == NULL) return -1;
+    for (i = 0; i < obj->num_design_configs && func->stvar.num_states < func->stvar.total_num_states; i++) {
+        int *config = &obj->design_configs[i * func->num_vars];
+        if (rtune_func_state_of_config(func, config) >= 0) continue;
+        printf("random search of func %s samples the config %d [", func->stvar.name, i);
+        for (j = 0; j < func->num_vars; j++) {
+            func->input_vars[j]->proposed_v_index = config[j];
+            printf("%s%s:%d", j > 0 ? ", " : "", func->input_vars[j]->stvar.name, config[j]);
+        }
+        printf("]\n");
+        return -1;
+    }
+    return func->stvar.num_states > 0 ? rtune_func_best_state(func, maximize) : -1;
+}
+
+/**
+ * Set up the random search of the func of the objective (see rtune_func_search_setup), and generate the configs of its
+ * design with the RNG of the region. A point of the design in the unit cube is mapped to a config by splitting the values
+ * of each var into equal parts. The first config is proposed right away. If the search cannot be set up or the design
+ * cannot be generated, the objective keeps the design it has, or falls back to the default search if it has none.
+ */
+static void rtune_objective_random_setup(rtune_objective_t *obj) {
+    rtune_func_t *func = obj->input_funcs[0].func;
+    rtune_region_t *region = obj->region;
+    int d = func->num_vars;
+    int n = obj->num_design_configs > 0 ? obj->num_design_configs : DEFAULT_random_samples_per_var * d;
+    int i, j;
+    double *points = NULL;
+    int *configs = NULL;
+    if (rtune_func_search_setup(func, n < func->stvar.total_num_states ? n : func->stvar.total_num_states, "random") == 0) {
+        points = (double *) rtune_arena_alloc(&region->arena, sizeof(double) * n * d);
+        configs = (int *) rtune_arena_alloc(&region->arena, sizeof(int) * n * d);
+    }
+    if (points == NULL || configs == NULL || rtune_design_generate(obj->design, n, d, &region->rng_state, points) < 0) {
+        if (obj->design_configs == NULL) rtune_objective_search_fallback(obj);
+        return;
+    }
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < d; j++) {
+            int num_values = func->input_vars[j]->num_unique_values;
+            int v = (int) (points[i * d + j] * num_values);
+            configs[i * d + j] = v < num_values ? v : num_values - 1;
+        }
+    }
+    obj->design_configs = configs;
+    obj->num_design_configs = n;
+    rtune_objective_random(obj, obj->kind == RTUNE_OBJECTIVE_MAX);
+}
+
+/**
+ * the search of the strategies that propose the values of the list/range var to sample, see rtune_objective_search_proposes
+ * @return the index of the state of the func at the optimum once the search converges, -1 if a value is proposed
+ */
+static int rtune_objective_search_1var(rtune_objective_t *obj, int maximize) {
+    switch (obj->search_strategy) {
+        case RTUNE_OBJECTIVE_SEARCH_MODEL:
+            return rtune_objective_model_1var(obj, maximize);
+        case RTUNE_OBJECTIVE_SEARCH_GOLDEN_SECTION:
+            return rtune_objective_golden_section_1var(obj, maximize);
+        case RTUNE_OBJECTIVE_SEARCH_BINARY_GRADIENT:
+            return rtune_objective_gradient_1var(obj, 2, maximize);
+        case RTUNE_OBJECTIVE_SEARCH_QUATERNARY_GRADIENT:
+            return rtune_objective_gradient_1var(obj, 4, maximize);
+        case RTUNE_OBJECTIVE_SEARCH_OCTAL_GRADIENT:
+            return rtune_objective_gradient_1var(obj, 8, maximize);
+        case RTUNE_OBJECTIVE_SEARCH_HEX_GRADIENT:
+            return rtune_objective_gradient_1var(obj, 16, maximize);
+        case RTUNE_OBJECTIVE_SEARCH_NELDER_MEAD:
+            return rtune_objective_nelder_mead(obj, maximize);
+        case RTUNE_OBJECTIVE_SEARCH_RANDOM:
+            return rtune_objective_random(obj, maximize);
+        default:
+            return -1;
+    }
+}
+
+/**
+ * the name of a search strategy that proposes the values to sample, for the log of the evaluation
+ */
+static const char *rtune_objective_search_name(rtune_objective_attribute_t search_strategy) {
+    switch (search_strategy) {
+        case RTUNE_OBJECTIVE_SEARCH_MODEL: return "model";
+        case RTUNE_OBJECTIVE_SEARCH_GOLDEN_SECTION: return "golden section";
+        case RTUNE_OBJECTIVE_SEARCH_BINARY_GRADIENT: return "binary gradient";
+        case RTUNE_OBJECTIVE_SEARCH_QUATERNARY_GRADIENT: return "quaternary gradient";
+        case RTUNE_OBJECTIVE_SEARCH_OCTAL_GRADIENT: return "octal gradient";
+        case RTUNE_OBJECTIVE_SEARCH_HEX_GRADIENT: return "hex gradient";
+        case RTUNE_OBJECTIVE_SEARCH_NELDER_MEAD: return "nelder-mead";
+        case RTUNE_OBJECTIVE_SEARCH_RANDOM: return "random";
+        default: return "unknown";
+    }
+}
+
+/**
+ * optimization of a unimodal function to find the max. A unimodal function has only one min/max and
+ * @param obj
+ * @return We would like the function return the index if the max is found. If the max is not found, the function should
+ *         return a value that representing the direction of searching (increment or decrement).
+ */
+static int rtune_objective_max_unimodal_gradient_1var(rtune_objective_t *obj) {
+    rtune_func_t *func = obj->input_funcs[0].func;
+    stvar_t *func_stvar = &func->stvar;
+
+    rtune_var_t *avar = func->active_var;
+    stvar_t *avar_stvar = &avar->stvar;
+    rtune_var_t *var = func->input_vars[0]; //this should be the active avar
+
+    //assert func_stvar->num_states == var_stvar->num_states;
+    int num_states = func_stvar->num_states;
+
+    //requires at least fidelity-trust-window number of states to calculate the gradient
+    int window_end;
+    if (num_states < obj->lookup_window) { //as long as the last fidelity_window amount of sampling data shows increase, we are good for meeting the obj
+        return -1;
+    } else {
+        window_end = num_states - obj->lookup_window;
+    }
+    //calculate gradient of the last fidelity_window number of states
+    int trend_decreasing = rtune_stvar_trend(func_stvar, window_end, obj->deviation_tolerance, 0);
+    if (trend_decreasing > 0) {
+        printf("trend decreasing in %d of the last %d states and greater than tolerance(%0.2f%%)\n", trend_decreasing, num_states - window_end, obj->deviation_tolerance*100);
+    }
+    if (trend_decreasing >= obj->fidelity_window) { //trend_increasing should be at least the same as fidelity window consecutively to be considered as obj being met
+        int index = rtune_stvar_state_index(func_stvar, num_states - trend_decreasing - 1);
+        printf("********* max (%d) reached within %d (fidelity window) decreasing ****************\n", index, obj->fidelity_window);
+        return index;
+    }
+
+    return -1;
+}
+
+/**
+ * This function find the max in the state starting from index start for count number of elements. If a pointer (minValue) to a variable
+ * is provided, the value in the variable will be included for finding the max, and the max found by this function will be copied
+ * back to the minValue pointer variable
+ * @param stvar: the stvar
+ * @param start: starting states
+ * @param count: the number of states to look for the max
+ * @param maxValue: if provided, to provide the initial max value for comparison and be used for returning the initial value
+ * @return: the index of the state that has the max, if not found, return -1
+ */
+#define STVAR_FIND_MAX_EXHAUSTIVE(TYPE, stvar, start, count, maxIndex, maxValue) \
+    TYPE *states = (TYPE*) stvar->states;          \
+    int i = rtune_kernel_argmax(RTUNE_##TYPE, states + start, count); \
+    if (i >= 0 && states[start + i] >= maxValue->_##TYPE##_value) { \
+        maxIndex = start + i; \
+        maxValue->_##TYPE##_value = states[maxIndex]; \
+    }
+
+
+int rtune_stvar_find_max(stvar_t * stvar, int start, int count, utype_t *maxValue) {
+	int num_states = stvar->num_states;
+	if (start < 0 || start + count > num_states) return -1;
+    return stvar->ops->find_max(stvar, start, count, maxValue);
+}
+
+/**
+ * instantiate the ops of a data type from the macros above, each op is a straight-line function of that type
+ */
+#define RTUNE_STVAR_OPS_DEFINE(TYPE) \
+    static utype_t rtune_stvar_get_value_##TYPE(stvar_t *stvar, int index) { \
+        utype_t v; \
+        v._##TYPE##_value = ((TYPE *) stvar->states)[index]; \
+        return v; \
+    } \
+    static utype_t rtune_stvar_read_##TYPE(void *(*provider) (void *), void *provider_arg) { \
+        utype_t v; \
+        if ((void *) provider == provider_arg) v._##TYPE##_value = *((TYPE *) provider); \
+        else v._##TYPE##_value = ((TYPE(*)(void *)) (void (*)(void)) provider)(provider_arg); \
+        return v; \
+    } \
+    static int rtune_stvar_equal_##TYPE(utype_t a, utype_t b) { \
+        return a._##TYPE##_value == b._##TYPE##_value; \
+    } \
+    static void rtune_stvar_put_##TYPE(void *states, int index, utype_t v) { \
+        ((TYPE *) states)[index] = v._##TYPE##_value; \
+    } \
+    static void rtune_stvar_push_##TYPE(stvar_t *stvar, utype_t v) { \
+        TYPE __state__ = v._##TYPE##_value; \
+        STVAR_UPDATE_NEXT_STATE(TYPE, stvar); \
+    } \
+    static double rtune_stvar_to_double_##TYPE(utype_t v) { \
+        return (double) v._##TYPE##_value; \
+    } \
+    static utype_t rtune_stvar_from_double_##TYPE(double x) { \
+        utype_t v; \
+        v._##TYPE##_value = (TYPE) x; \
+        return v; \
+    } \
+    static void rtune_var_update_list_##TYPE(rtune_var_t *var, int index) { \
+        stvar_t *stvar = &var->stvar; \
+        RTUNE_VAR_UPDATE_LIST(TYPE, var, stvar, index); \
+    } \
+    static void rtune_var_update_range_##TYPE(rtune_var_t *var, int index) { \
+        stvar_t *stvar = &var->stvar; \
+        RTUNE_VAR_UPDATE_RANGE(TYPE, var, stvar, index); \
+    } \
+    static void rtune_stvar_update_ext_straight_##TYPE(stvar_t *stvar) { \
+        RTUNE_STVAR_UPDATE_EXT(TYPE, stvar); \
+    } \
+    static void rtune_stvar_update_ext_accu4Begin_##TYPE(stvar_t *stvar, int update) { \
+        RTUNE_STVAR_UPDATE_EXT_accu4Begin(TYPE, stvar, update); \
+    } \
+    static void rtune_stvar_update_diff_base4Diff_##TYPE(stvar_t *stvar) { \
+        RTUNE_STVAR_UPDATE_DIFF_base4Diff(TYPE, stvar); \
+    } \
+    static void rtune_stvar_update_ext_accu4End_##TYPE(stvar_t *stvar, int update) { \
+        RTUNE_STVAR_UPDATE_EXT_accu4End(TYPE, stvar, update); \
+    } \
+    static void rtune_stvar_update_diff_accu4Diff_##TYPE(stvar_t *stvar, int update) { \
+        RTUNE_STVAR_UPDATE_DIFF_accu4Diff(TYPE, stvar, update); \
+    } \
+    static int rtune_stvar_find_min_##TYPE(stvar_t *stvar, int start, int count, utype_t *minValue) { \
+        int index = -1; \
+        STVAR_FIND_MIN_EXHAUSTIVE(TYPE, stvar, start, count, index, minValue); \
+        return index; \
+    } \
+    static int rtune_stvar_find_max_##TYPE(stvar_t *stvar, int start, int count, utype_t *maxValue) { \
+        int index = -1; \
+        STVAR_FIND_MAX_EXHAUSTIVE(TYPE, stvar, start, count, index, maxValue); \
+        return index; \
+    } \
+    static const rtune_stvar_ops_t rtune_stvar_ops_##TYPE = { \
+        sizeof(TYPE), \
+        rtune_stvar_get_value_##TYPE, \
+        rtune_stvar_read_##TYPE, \
+        rtune_stvar_equal_##TYPE, \
+        rtune_var_update_list_##TYPE, \
+        rtune_var_update_range_##TYPE, \
+        rtune_stvar_update_ext_straight_##TYPE, \
+        rtune_stvar_update_ext_accu4Begin_##TYPE, \
+        rtune_stvar_update_diff_base4Diff_##TYPE, \
+        rtune_stvar_update_ext_accu4End_##TYPE, \
+        rtune_stvar_update_diff_accu4Diff_##TYPE, \
+        rtune_stvar_find_min_##TYPE, \
+        rtune_stvar_find_max_##TYPE, \
+        rtune_stvar_put_##TYPE, \
+        rtune_stvar_push_##TYPE, \
+        rtune_stvar_to_double_##TYPE, \
+        rtune_stvar_from_double_##TYPE, \
+    };
+
+RTUNE_STVAR_OPS_DEFINE(short)
+RTUNE_STVAR_OPS_DEFINE(int)
+RTUNE_STVAR_OPS_DEFINE(long)
+RTUNE_STVAR_OPS_DEFINE(float)
+RTUNE_STVAR_OPS_DEFINE(double)
+
+/**
+ * ops of RTUNE_void, whose states are pointers. They can only be read and compared, the updates are no-op as before
+ */
+static utype_t rtune_stvar_get_value_void(stvar_t *stvar, int index) {
+    utype_t v;
+    v._typed_value = ((void **) stvar->states)[index];
+    return v;
+}
+static utype_t rtune_stvar_read_void(void *(*provider) (void *), void *provider_arg) {
+    utype_t v;
+    if ((void *) provider == provider_arg) v._typed_value = *((void **) provider);
+    else v._typed_value = provider(provider_arg);
+    return v;
+}
+static int rtune_stvar_equal_void(utype_t a, utype_t b) { return a._typed_value == b._typed_value; }
+static void rtune_var_update_void(rtune_var_t *var, int index) { (void) var; (void) index; }
+static void rtune_stvar_update_void(stvar_t *stvar) { (void) stvar; }
+static void rtune_stvar_update_batch_void(stvar_t *stvar, int update) { (void) stvar; (void) update; }
+static int rtune_stvar_find_void(stvar_t *stvar, int start, int count, utype_t *value) {
+    (void) stvar; (void) start; (void) count; (void) value;
+    return -1;
+}
+static void rtune_stvar_put_void(void *states, int index, utype_t v) { ((void **) states)[index] = v._typed_value; }
+static void rtune_stvar_push_void(stvar_t *stvar, utype_t v) { (void) stvar; (void) v; }
+static double rtune_stvar_to_double_void(utype_t v) { (void) v; return 0.0; }
+static utype_t rtune_stvar_from_double_void(double x) { utype_t v; (void) x; v._typed_value = NULL; return v; }
+
+static const rtune_stvar_ops_t rtune_stvar_ops_void = {
+    sizeof(void *),
+    rtune_stvar_get_value_void,
+    rtune_stvar_read_void,
+    rtune_stvar_equal_void,
+    rtune_var_update_void,
+    rtune_var_update_void,
+    rtune_stvar_update_void,
+    rtune_stvar_update_batch_void,
+    rtune_stvar_update_void,
+    rtune_stvar_update_batch_void,
+    rtune_stvar_update_batch_void,
+    rtune_stvar_find_void,
+    rtune_stvar_find_void,
+    rtune_stvar_put_void,
+    rtune_stvar_push_void,
+    rtune_stvar_to_double_void,
+    rtune_stvar_from_double_void,
+};
+
+static const rtune_stvar_ops_t *rtune_stvar_ops_of(rtune_data_type_t type) {
+    switch (type) {
+        case RTUNE_short:
+            return &rtune_stvar_ops_short;
+        case RTUNE_int:
+            return &rtune_stvar_ops_int;
+        case RTUNE_long:
+            return &rtune_stvar_ops_long;
+        case RTUNE_float:
+            return &rtune_stvar_ops_float;
+        case RTUNE_double:
+            return &rtune_stvar_ops_double;
+        default:
+            return &rtune_stvar_ops_void;
+    }
+}
+
+/**
+ * mark a derived func for update since its inputs have new states, see rtune_region_derive_dirty. A func added after the
+ * region is compiled is not in the DAG yet, it catches up with the states of its inputs once it is.
+ */
+static inline void rtune_func_mark_dirty(rtune_func_t * func) {
+    int i = func->topo_index;
+    if (i >= 0) func->region->dirty_funcs[i / RTUNE_BITS_PER_WORD] |= 1UL << (i % RTUNE_BITS_PER_WORD);
+}
+
+/**
+ * A func has a new state at index, record the input of the new state, check whether its update completes and mark
+ * the objectives that use this func as due for evaluation at the end of this iteration. The derived funcs that use
+ * this func are updated with the new state.
+ * @param source the func a derived func is derived from, whose input vars at source_index are recorded as the input of the
+ *        new state instead of the current values of the vars, NULL if the state is from the current values
+ */
+static void rtune_func_sampled(rtune_func_t * func, int index, int count, rtune_func_t * source, int source_index) {
+    stvar_t *stvar = &func->stvar;
+    func->unused_updates++;
+    rtune_samples_t *samples = &func->samples;
+    samples->iteration[index] = source != NULL ? source->samples.iteration[source_index] : count;
+    int j, k;
+    for (j = 0; j < func->num_vars; j++) {
+        //The input of the func from the var is always the last state of the var as it is latest update since
+        //the var of a func is only updated one a time (by restricting their schedule to not overlap)
+        stvar_t *var_stvar = &func->input_vars[j]->stvar;
+        k = 0;
+        if (source != NULL) while (k < source->num_vars && source->input_vars[k] != func->input_vars[j]) k++;
+        if (source != NULL && k < source->num_vars) {
+            size_t size = var_stvar->ops->size;
+            samples->var_index[j][index] = source->samples.var_index[k][source_index];
+            memcpy((char *) samples->var_value[j] + index * size, (char *) source->samples.var_value[k] + source_index * size, size);
+        } else {
+            samples->var_index[j][index] = var_stvar->num_states > 0 ? var_stvar->last_index : -1;
+            var_stvar->ops->put(samples->var_value[j], index, var_stvar->v);
+        }
+    }
+    if (func->model != NULL && func->num_vars > 0) {
+        rtune_model_add_sample(func->model, rtune_column_double(rtune_func_column_var(func, 0), index),
+                               stvar->ops->to_double(rtune_stvar_get_value(stvar, index)));
+    }
+
+    if (stvar->total_num_states == stvar->num_states && stvar->trace_mode == RTUNE_TRACE_FLAT) {//update completed at the beginning of the last batch
+        func->status = RTUNE_STATUS_UPDATE_COMPLETE;
+        rtune_func_print_doubleFunc_intVar(func, count);
+        //TODO: we might not use total_num_states for condition check
+    }
+
+    rtune_region_t *region = func->region;
+    for (j = 0; j < func->num_objs; j++) {
+        rtune_objective_t *obj = func->objectives[j];
+        k = 0;
+        while (k < region->num_due_objs && region->due_objs[k] != obj) k++;
+        if (k == region->num_due_objs) region->due_objs[region->num_due_objs++] = obj;
+    }
+    for (j = 0; j < func->num_uses; j++) rtune_func_mark_dirty(func->usedByFuncs[j]);
+}
+
+/**
+ * a var has a new state, mark the derived funcs that are derived from vars only for update
+ */
+static void rtune_var_sampled(rtune_var_t * var) {
+    int j;
+    for (j = 0; j < var->num_uses; j++) {
+        rtune_func_t *func = var->usedByFuncs[j];
+        if (rtune_func_is_derived(func) && func->num_input_funcs == 0) rtune_func_mark_dirty(func);
+    }
+}
+
+/**
+ * where the state of the update-th update of a stvar is stored
+ * @return the index, -1 if the state is dropped from the trace
+ */
+static int rtune_stvar_update_index(stvar_t * stvar, long update) {
+    if (update < 0 || update >= stvar->num_updates) return -1;
+    if (stvar->trace_mode == RTUNE_TRACE_RING) {
+        return update >= stvar->num_updates - stvar->num_states ? (int) (update % stvar->total_num_states) : -1;
+    }
+    return update < stvar->num_states ? (int) update : -1;
+}
+
+#define RTUNE_DERIVE_CHUNK 32 //number of states a derived func is evaluated for at once
+
+/**
+ * Evaluate a derived func for n states of its operands, a, b and c are the values of the first three operands of each
+ * state. The kind is dispatched once for the chunk so the loops are vectorizable. A state that has no value is dropped,
+ * and the source indices of the states are compacted with the values so each value keeps the sample it is derived from.
+ * The log has no value for an operand that is not positive, which is dropped instead of clamped since -inf or NaN breaks
+ * the argmin/argmax of the objectives and any clamped value would be taken as a real sample.
+ * @return the number of values, which is fewer than n for the log of a non-positive operand and for the gradient that
+ *         has no value for an unchanged input var
+ */
+static int rtune_derive_values(rtune_func_t * func, int n, const double *a, const double *b, const double *c, double *out,
+                               int *source_index) {
+    double coef = func->num_coefs > 0 ? func->operands[0]->ops->to_double(func->input_coefs[0]) : 0.0;
+    int i;
+    switch (func->kind) {
+        case RTUNE_FUNC_LOG: {
+            int num_values = 0;
+            for (i = 0; i < n; i++) {
+                if (!(a[i] > 0.0)) continue;
+                source_index[num_values] = source_index[i];
+                out[num_values++] = log(a[i]);
+            }
+            return num_values;
+        }
+        case RTUNE_FUNC_ABS:
+            for (i = 0; i < n; i++) out[i] = fabs(a[i]);
+            return n;
+        case RTUNE_FUNC_DIFF:
+            for (i = 0; i < n; i++) out[i] = a[i] - b[i];
+            return n;
+        case RTUNE_FUNC_DISTANCE:
+            for (i = 0; i < n; i++) out[i] = a[i] - coef;
+            return n;
+        case RTUNE_FUNC_THRESHOLD:
+            for (i = 0; i < n; i++) out[i] = a[i] < coef ? 0.0 : 1.0;
+            return n;
+        case RTUNE_FUNC_RATIO:
+            for (i = 0; i < n; i++) out[i] = b[i] != 0.0 ? a[i] / b[i] : 0.0;
+            return n;
+        case RTUNE_FUNC_PRODUCT:
+            for (i = 0; i < n; i++) out[i] = a[i] * b[i];
+            return n;
+        case RTUNE_FUNC_EFFICIENCY: //a is the exe time, b the num_threads and c the work
+            for (i = 0; i < n; i++) out[i] = a[i] > 0.0 && b[i] > 0.0 ? c[i] / (a[i] * b[i]) : 0.0;
+            return n;
+        case RTUNE_FUNC_GRADIENT: { //a is the input and b the x it is over, the last ones are kept in the accumulators
+            stvar_t *stvar = &func->stvar;
+            int num_values = 0;
+            for (i = 0; i < n; i++) {
+                double dx = b[i] - stvar->accu4End_or_accu4Diff._double_value;
+                if (func->num_derived + i > 0 && dx != 0.0) {
+                    source_index[num_values] = source_index[i];
+                    out[num_values++] = (a[i] - stvar->accu4Begin_or_base4Diff._double_value) / dx;
+                }
+                stvar->accu4Begin_or_base4Diff._double_value = a[i];
+                stvar->accu4End_or_accu4Diff._double_value = b[i];
+            }
+            return num_values;
+        }
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Update a derived func with the new states of its operands. A func with func operands is updated for each update of
+ * all its func operands, from their states of that update, and the var operands are read from the samples of the first
+ * func operand if they are its input vars, or from their current values otherwise. The updates are evaluated in chunks,
+ * which are normally a single update, but catch up with the states of the func operands the derived func has not been
+ * updated with, e.g. when it is added after them. A func with var operands only is updated from their current values.
+ */
+static void rtune_func_derive(rtune_func_t * func, int count) {
+    if (func->status >= RTUNE_STATUS_UPDATE_COMPLETE) return;
+    if (func->status < RTUNE_STATUS_SAMPLING) func->status = RTUNE_STATUS_SAMPLING;
+
+    stvar_t *stvar = &func->stvar;
+    rtune_func_t *source = func->num_input_funcs > 0 ? func->input_funcs[0] : NULL;
+    long first = func->num_derived;
+    long last = first + 1;
+    int i, j;
+    if (source != NULL) {
+        last = LONG_MAX;
+        for (j = 0; j < func->num_input_funcs; j++) {
+            if (func->input_funcs[j]->stvar.num_updates < last) last = func->input_funcs[j]->stvar.num_updates;
+        }
+        if (last < first) first = last - 1; //the func operands are resetted
+        if (last <= first) return; //not all the func operands have a new state yet
+    }
+
+    double values[3][RTUNE_DERIVE_CHUNK];
+    double out[RTUNE_DERIVE_CHUNK];
+    int source_index[RTUNE_DERIVE_CHUNK];
+    while (first < last) {
+        int n = 0;
+        for (; first < last && n < RTUNE_DERIVE_CHUNK; first++) {
+            int index = source != NULL ? rtune_stvar_update_index(&source->stvar, first) : -1;
+            if (source != NULL && index < 0) continue;
+            for (j = 0; j < func->num_operands && j < 3; j++) {
+                stvar_t *operand = func->operands[j];
+                int column = func->operand_columns[j];
+                if (column == RTUNE_OPERAND_FUNC) { //a func operand, at its state of this update
+                    int operand_index = rtune_stvar_update_index(operand, first);
+                    values[j][n] = operand->ops->to_double(operand_index >= 0 ? rtune_stvar_get_value(operand, operand_index) : operand->v);
+                } else if (column >= 0) { //an input var of the source, at the sample of this update
+                    values[j][n] = rtune_column_double(rtune_func_column_var(source, column), index);
+                } else {
+                    values[j][n] = operand->ops->to_double(operand->v);
+                }
+            }
+            if (func->kind == RTUNE_FUNC_GRADIENT) { //over the first input var of the func operand, or over the updates
+                values[1][n] = source != NULL && source->num_vars > 0 ? rtune_column_double(rtune_func_column_var(source, 0), index) : (double) first;
+            } else if (func->kind == RTUNE_FUNC_EFFICIENCY && func->num_operands < 3) {
+                values[2][n] = 1.0; //fixed work
+            }
+            source_index[n++] = index;
+        }
+        int num_values = rtune_derive_values(func, n, values[0], values[1], values[2], out, source_index);
+        func->num_derived = first; //the updates that are dropped from the trace of the source are passed too
+        for (i = 0; i < num_values; i++) {
+            if (stvar->num_states == func->samples.capacity && stvar->num_states < stvar->total_num_states && rtune_func_samples_grow(func) != 0) return;
+            stvar->ops->push(stvar, stvar->ops->from_double(out[i]));
+            int from = source_index[i];
+            if (stvar->last_index >= 0) rtune_func_sampled(func, stvar->last_index, count, from >= 0 ? source : NULL, from);
+            if (func->status >= RTUNE_STATUS_UPDATE_COMPLETE) return;
+        }
+    }
+}
+
+static int rtune_sched_update_at_begin(rtune_var_update_kind_t update_lt) {
+    return update_lt == RTUNE_UPDATE_REGION_BEGIN || update_lt == RTUNE_UPDATE_REGION_BEGIN_END ||
+           update_lt == RTUNE_UPDATE_REGION_BEGIN_END_DIFF;
+}
+
+static int rtune_sched_update_at_end(rtune_var_update_kind_t update_lt) {
+    return update_lt == RTUNE_UPDATE_REGION_END || update_lt == RTUNE_UPDATE_REGION_BEGIN_END ||
+           update_lt == RTUNE_UPDATE_REGION_BEGIN_END_DIFF;
+}
+
+/**
+ * the next iteration, starting from count, that the entry is due
+ */
+static int rtune_sched_next(rtune_sched_t *entry, int count) {
+    int next;
+    if (count <= entry->start) next = entry->start;
+    else {
+        int batch_index = (count - entry->start) % entry->period;
+        if (batch_index == 0 || (entry->every_iteration && batch_index < entry->batch_size)) next = count;
+        else next = count - batch_index + entry->period;
+    }
+    return next >= entry->end ? INT_MAX : next;
+}
+
+static void rtune_sched_add(rtune_sched_t *table, int *num_entries, rtune_var_t *var, rtune_func_t *func, rtune_var_update_kind_t update_lt,
+                            rtune_var_update_kind_t update_policy, int start, int batch_size, int stride, int end, int count) {
+    int i;
+    for (i = 0; i < *num_entries; i++) { //a func following vars with the same schedule only needs one entry
+        rtune_sched_t *e = &table[i];
+        if (func != NULL && e->func == func && e->start == start && e->batch_size == batch_size && e->period == batch_size + stride &&
+            e->update_policy == update_policy && e->update_lt == update_lt) {
+            if (end > e->end) e->end = end;
+            e->next = rtune_sched_next(e, count);
+            return;
+        }
+    }
+    rtune_sched_t *entry = &table[(*num_entries)++];
+    entry->var = var;
+    entry->func = func;
+    entry->update_lt = update_lt;
+    entry->update_policy = update_policy;
+    entry->start = start;
+    entry->batch_size = batch_size > 0 ? batch_size : 1;
+    entry->period = entry->batch_size + (stride > 0 ? stride : 0);
+    entry->end = end;
+    entry->every_iteration = update_policy == RTUNE_UPDATE_BATCH_ACCUMULATE || rtune_batch_reducer(update_policy);
+    entry->next = rtune_sched_next(entry, count);
+    if (rtune_batch_reducer(update_policy)) {
+        if (func != NULL) rtune_stvar_reserve_batch(func->region, &func->stvar, entry->batch_size, func->samples.capacity);
+        else rtune_stvar_reserve_batch(var->region, &var->stvar, entry->batch_size, var->stvar.total_num_states);
+    }
+}
+
+/**
+ * Build the topological order of the derived funcs from the usedByFuncs links (Kahn's algorithm), a derived func is after
+ * all the derived funcs it is derived from, so the dirty funcs can be updated in one pass in the order. The vars and the
+ * scheduled funcs are the sources of the DAG and the objectives are its sinks, which are evaluated after the derived
+ * funcs, see rtune_region_end.
+ */
+static void rtune_region_compile_dag(rtune_region_t * region) {
+    int i, j;
+    int num_derived = 0;
+    for (i = 0; i < region->num_funcs; i++) {
+        rtune_func_t *func = region->funcs[i];
+        func->topo_index = -1;
+        if (rtune_func_is_derived(func)) num_derived++;
+    }
+    if (num_derived > region->topo_capacity) {
+        int num_words = (num_derived + RTUNE_BITS_PER_WORD - 1) / RTUNE_BITS_PER_WORD;
+        region->topo_funcs = (rtune_func_t **) rtune_arena_alloc(&region->arena, sizeof(rtune_func_t *) * num_words * RTUNE_BITS_PER_WORD);
+        region->dirty_funcs = (unsigned long *) rtune_arena_alloc(&region->arena, sizeof(unsigned long) * num_words);
+        if (region->topo_funcs == NULL || region->dirty_funcs == NULL) {
+            region->topo_capacity = region->num_topo_funcs = 0;
+            return;
+        }
+        region->topo_capacity = num_words * RTUNE_BITS_PER_WORD;
+    }
+
+    //the in-degree of a derived func is the number of its func operands that are derived too, which is kept in topo_index
+    //as -2 - in-degree until it drops to 0 and the func is ordered
+    int num_ready = 0;
+    for (i = 0; i < region->num_funcs; i++) {
+        rtune_func_t *func = region->funcs[i];
+        if (!rtune_func_is_derived(func)) continue;
+        int degree = 0;
+        for (j = 0; j < func->num_input_funcs; j++) degree += rtune_func_is_derived(func->input_funcs[j]);
+        if (degree == 0) region->topo_funcs[num_ready++] = func;
+        else func->topo_index = -2 - degree;
+    }
+    int next;
+    for (next = 0; next < num_ready; next++) {
+        rtune_func_t *func = region->topo_funcs[next];
+        func->topo_index = next;
+        for (j = 0; j < func->num_uses; j++) {
+            rtune_func_t *derived = func->usedByFuncs[j];
+            if (derived->topo_index < -1 && ++derived->topo_index == -2) region->topo_funcs[num_ready++] = derived;
+        }
+    }
+    region->num_topo_funcs = num_ready;
+    if (region->topo_capacity > 0) memset(region->dirty_funcs, 0, sizeof(unsigned long) * (region->topo_capacity / RTUNE_BITS_PER_WORD));
+}
+
+/**
+ * update the dirty derived funcs in the topological order, the funcs they mark dirty are after them in the order so
+ * they are updated in the same pass
+ */
+static void rtune_region_derive_dirty(rtune_region_t * region, int count) {
+    int num_words = (region->num_topo_funcs + RTUNE_BITS_PER_WORD - 1) / RTUNE_BITS_PER_WORD;
+    int w;
+    for (w = 0; w < num_words; w++) {
+        while (region->dirty_funcs[w] != 0) {
+            int bit = __builtin_ctzl(region->dirty_funcs[w]);
+            region->dirty_funcs[w] &= ~(1UL << bit);
+            rtune_func_derive(region->topo_funcs[w * RTUNE_BITS_PER_WORD + bit], count);
+        }
+    }
+}
+
+/**
+ * Compile the update schedule attrs of all the vars and funcs of the region into the begin and end schedule tables.
+ * For a func whose attrs are RTUNE_DEFAULT_NONE, an entry is created for each of its input vars with the attrs of that var and
+ * the entry ends when that var completes its batches, since the vars of a func are updated one by one
+ * (see rtune_func_schedule_check). This is called by rtune_region_begin whenever a var/func is added, resetted or its
+ * schedule is changed, and can be called once by the user after setting up the region to take it off the first iteration.
+ */
+void rtune_region_compile(rtune_region_t * region) {
+    int count = region->count < 0 ? 0 : region->count;
+    int max_entries = region->num_vars;
+    int i, j;
+    for (i = 0; i < region->num_funcs; i++) max_entries += region->funcs[i]->num_vars > 0 ? region->funcs[i]->num_vars : 1;
+    if (max_entries + 1 > region->sched_capacity) { //the tables are reused by recompiling unless the region grows
+        region->sched_capacity = max_entries + 1;
+        region->begin_sched = (rtune_sched_t *) rtune_arena_alloc(&region->arena, sizeof(rtune_sched_t) * region->sched_capacity);
+        region->end_sched = (rtune_sched_t *) rtune_arena_alloc(&region->arena, sizeof(rtune_sched_t) * region->sched_capacity);
+        region->on_read_vars = (rtune_var_t **) rtune_arena_alloc(&region->arena, sizeof(rtune_var_t *) * region->sched_capacity);
+    }
+    region->num_begin_sched = 0;
+    region->num_end_sched = 0;
+    region->num_on_read_vars = 0;
+
+    //vars first since the funcs record the latest state of their vars when they are updated
+    for (i = 0; i < region->num_vars; i++) {
+        rtune_var_t *var = region->vars[i];
+        if (var->apply_policy == RTUNE_VAR_APPLY_ON_READ && var->stvar.applier != NULL && var->status != RTUNE_STATUS_RETIRED)
+            region->on_read_vars[region->num_on_read_vars++] = var;
+        if (var->status >= RTUNE_STATUS_UPDATE_COMPLETE || !rtune_sched_update_at_begin(var->update_lt)) continue;
+        rtune_sched_add(region->begin_sched, &region->num_begin_sched, var, NULL, var->update_lt, var->update_policy,
+                        var->sched_origin + var->update_iteration_start, var->batch_size, var->update_iteration_stride, INT_MAX, count);
+    }
+
+    for (i = 0; i < region->num_funcs; i++) {
+        rtune_func_t *func = region->funcs[i];
+        if (func->status >= RTUNE_STATUS_UPDATE_COMPLETE || rtune_func_is_derived(func)) continue; //derived funcs are not scheduled
+        int num_followed = func->num_vars > 0 ? func->num_vars : 1;
+        if (func->num_vars > 0) func->active_var = func->input_vars[0];
+        for (j = 0; j < num_followed; j++) {
+            rtune_var_t *avar = func->num_vars > 0 ? func->input_vars[j] : NULL;
+            rtune_var_update_kind_t update_lt = func->update_lt;
+            rtune_var_update_kind_t update_policy = func->update_policy;
+            int start = func->sched_origin + func->update_iteration_start;
+            int batch_size = func->batch_size;
+            int stride = func->update_iteration_stride;
+            int end = INT_MAX;
+            if (avar != NULL) {
+                if (update_lt == RTUNE_DEFAULT_NONE) update_lt = avar->update_lt;
+                if (update_policy == RTUNE_DEFAULT_NONE) update_policy = avar->update_policy;
+                if (batch_size == RTUNE_DEFAULT_NONE) batch_size = avar->batch_size;
+                if (stride == RTUNE_DEFAULT_NONE) stride = avar->update_iteration_stride;
+                if (func->update_iteration_start == RTUNE_DEFAULT_NONE) {
+                    //following the var schedule, which ends after the var completes its batches unless the var or the
+                    //func keeps a ring trace, which never completes
+                    start = avar->sched_origin + avar->update_iteration_start;
+                    int total_num_states = avar->stvar.total_num_states;
+                    int num_batches = (avar->update_lt == RTUNE_UPDATE_REGION_BEGIN_END) ? (total_num_states+1)/2 : total_num_states;
+                    if (avar->stvar.trace_mode != RTUNE_TRACE_RING && func->stvar.trace_mode != RTUNE_TRACE_RING)
+                        end = start + num_batches * (batch_size + stride);
+                }
+            } else if (update_lt == RTUNE_DEFAULT_NONE) continue; //nothing to follow
+
+            if (rtune_sched_update_at_begin(update_lt))
+                rtune_sched_add(region->begin_sched, &region->num_begin_sched, avar, func, update_lt, update_policy, start, batch_size, stride, end, count);
+            if (rtune_sched_update_at_end(update_lt))
+                rtune_sched_add(region->end_sched, &region->num_end_sched, avar, func, update_lt, update_policy, start, batch_size, stride, end, count);
+            if (func->update_iteration_start != RTUNE_DEFAULT_NONE) break; //the func has its own schedule, no need to follow each var
+        }
+    }
+
+    rtune_region_compile_dag(region);
+
+    region->next_begin = INT_MAX;
+    for (i = 0; i < region->num_begin_sched; i++)
+        if (region->begin_sched[i].next < region->next_begin) region->next_begin = region->begin_sched[i].next;
+    region->next_end = INT_MAX;
+    for (i = 0; i < region->num_end_sched; i++)
+        if (region->end_sched[i].next < region->next_end) region->next_end = region->end_sched[i].next;
+    if (region->num_on_read_vars > 0) region->hot_status |= RTUNE_REGION_HOT_APPLY;
+    else region->hot_status &= ~RTUNE_REGION_HOT_APPLY;
+    region->sched_dirty = 0;
+}
+
+/**
+ * move the entry to its next due iteration after it is processed in the iteration count
+ */
+static void rtune_sched_advance(rtune_sched_t *entry, int count) {
+    entry->next = rtune_sched_next(entry, count + 1);
+}
+
+static void rtune_sched_var_begin(rtune_sched_t *entry, int count) {
+    rtune_var_t *var = entry->var;
+    if (var->status >= RTUNE_STATUS_UPDATE_COMPLETE) { //update is complete or retired
+        entry->next = INT_MAX;
+        return;
+    }
+    //the setting of enabling a variable update is solely determined by the update_iteration_start. Thus if a function
+    //has two more more variables, they need to be updated one by one. Their schedules should NOT overlap, see rtune_func_schedule_check func
+    if (var->status < RTUNE_STATUS_SAMPLING) var->status = RTUNE_STATUS_SAMPLING;
+
+    stvar_t * stvar = &var->stvar;
+    int batch_index = (count - entry->start) % entry->period;
+    int index = -1; //the index to access the state of the new var of the variable
+
+    switch (var->kind) {
+        case RTUNE_VAR_LIST:
+        case RTUNE_VAR_RANGE: {
+            if (batch_index == 0) {
+                index = rtune_var_update_list_range(var);
+                //rtune_var_print_list_range(var, count);
+            }
+            break;
+        }
+        case RTUNE_VAR_EXT:
+            index = rtune_stvar_ext_update_begin(stvar, entry->update_policy, batch_index, entry->batch_size);
+            break;
+#if USING_VAR_EXT_DIFF_IS_USEFUL
+        case RTUNE_VAR_EXT_DIFF: {
+            rtune_stvar_ext_diff_update_begin(stvar, entry->update_policy, batch_index);
+            break;
+        }
+#endif
+        default:
+            break;
+    }
+    if (index >=0 ) { //update this config in the config and apply this var config
+        rtune_var_apply(var, index, count);
+        rtune_var_sampled(var);
+        if (stvar->total_num_states == stvar->num_states && stvar->trace_mode == RTUNE_TRACE_FLAT) {//update completed and this is last iteration of the last batch.
+            var->status = RTUNE_STATUS_UPDATE_COMPLETE;
+            //rtune_var_print_list_range(var, count);
+        }
+    }
+    rtune_sched_advance(entry, count);
+}
+
+static void rtune_sched_func_begin(rtune_sched_t *entry, int count) {
+    rtune_func_t *func = entry->func;
+    if (func->status >= RTUNE_STATUS_UPDATE_COMPLETE) { //no more updated needed
+        entry->next = INT_MAX;
+        return;
+    }
+    //grow only until the total number of states, a full flat trace drops the new states and a full ring trace overwrites them
+    if (func->stvar.num_states == func->samples.capacity && func->stvar.num_states < func->stvar.total_num_states &&
+        rtune_func_samples_grow(func) != 0) return; //no room for a new sample
+    if (entry->var != NULL) func->active_var = entry->var;
+    if (func->status < RTUNE_STATUS_SAMPLING) func->status = RTUNE_STATUS_SAMPLING;
+
+    int batch_index = (count - entry->start) % entry->period;
+    int index = -1;
+    switch (func->kind) {
+        case RTUNE_FUNC_EXT:
+            index = rtune_stvar_ext_update_begin(&func->stvar, entry->update_policy, batch_index, entry->batch_size);
+            break;
+        case RTUNE_FUNC_EXT_DIFF:
+            rtune_stvar_ext_diff_update_begin(&func->stvar, entry->update_policy, batch_index);
+            break;
+        default:
+            break;
+    }
+    if (index >= 0) rtune_func_sampled(func, index, count, NULL, -1);
+    rtune_sched_advance(entry, count);
+}
+
+static void rtune_sched_func_end(rtune_sched_t *entry, int count) {
+    rtune_func_t *func = entry->func;
+    if (func->status >= RTUNE_STATUS_UPDATE_COMPLETE) {
+        entry->next = INT_MAX;
+        return;
+    }
+    //grow only until the total number of states, a full flat trace drops the new states and a full ring trace overwrites them
+    if (func->stvar.num_states == func->samples.capacity && func->stvar.num_states < func->stvar.total_num_states &&
+        rtune_func_samples_grow(func) != 0) return; //no room for a new sample
+    if (entry->var != NULL) func->active_var = entry->var;
+    if (func->status < RTUNE_STATUS_SAMPLING && entry->update_lt == RTUNE_UPDATE_REGION_END) func->status = RTUNE_STATUS_SAMPLING;
+
+    int batch_index = (count - entry->start) % entry->period;
+    int index = -1;
+    switch (func->kind) {
+        case RTUNE_FUNC_EXT:
+            index = rtune_stvar_ext_update_end(&func->stvar, entry->update_policy, batch_index, entry->batch_size);
+            break;
+        case RTUNE_FUNC_EXT_DIFF:
+            index = rtune_stvar_ext_diff_update_end(&func->stvar, entry->update_policy, batch_index, entry->batch_size);
+            break;
+        default:
+            break;
+    }
+    if (index >= 0) rtune_func_sampled(func, index, count, NULL, -1);
+    rtune_sched_advance(entry, count);
+}
+
+/**
+ * apply the configs of the retired objectives whose apply policy is RTUNE_VAR_APPLY_ON_READ, called for each iteration
+ */
+static void rtune_region_apply_configs(rtune_region_t * region, int count) {
+    int i, j;
+    for (i = 0; i < region->num_objs; i++) {
+        rtune_objective_t *obj = region->objs[i];
+        if (obj->status != RTUNE_STATUS_RETIRED) continue;
+        for (j = 0; j < obj->num_vars; j++) {
+            struct input_var *config = &obj->input_vars[j];
+            if (config->apply_policy != RTUNE_VAR_APPLY_ON_READ || config->applier == NULL || config->index < 0) continue;
+            if (rtune_apply_on_read(config->applier, config->ops, config->value, &config->apply_check))
+                config->last_iteration_applied = count;
+        }
+    }
+}
+
+/**
+ * the hot status of a region that all its objectives are retired: 0 unless some configs need to be applied in each iteration
+ */
+static int rtune_region_retired_hot_status(rtune_region_t * region) {
+    int i, j;
+    for (i = 0; i < region->num_objs; i++) {
+        rtune_objective_t *obj = region->objs[i];
+        for (j = 0; j < obj->num_vars; j++) {
+            struct input_var *config = &obj->input_vars[j];
+            if (config->apply_policy == RTUNE_VAR_APPLY_ON_READ && config->applier != NULL && config->index >= 0)
+                return RTUNE_REGION_HOT_APPLY;
+        }
+    }
+    return 0;
+}
+
+/**
+ * re-apply the current states of the vars with RTUNE_VAR_APPLY_ON_READ that are being tuned, called for each iteration.
+ * A var that is just applied for its new state in this iteration is skipped.
+ */
+static void rtune_region_apply_on_read_vars(rtune_region_t * region, int count) {
+    int i;
+    for (i = 0; i < region->num_on_read_vars; i++) {
+        rtune_var_t *var = region->on_read_vars[i];
+        if (var->current_apply_index < 0 || var->last_apply_iteration == count || var->status == RTUNE_STATUS_RETIRED) continue;
+        utype_t v = rtune_var_get_value(var, var->current_apply_index);
+        if (rtune_apply_on_read(var->stvar.applier, var->stvar.ops, v, &var->apply_check)) var->last_apply_iteration = count;
+    }
+}
+
+void rtune_region_begin(rtune_region_t * region) {
+    //printf("RTune region: %s(%x) begin, count: %d\n", region->name, region, count);
+    //we need a flag to simply ignore the rest if rtune's job is done
+    int count = ++region->count;
+    if (region->status == RTUNE_STATUS_RETIRED) {
+        if (region->hot_status & RTUNE_REGION_HOT_APPLY) rtune_region_apply_configs(region, count);
+    	return;
+    }
+    region->epoch++;
+    if (region->sched_dirty) rtune_region_compile(region);
+    if (count >= region->next_begin) {
+        //Only the entries that are due are processed. The var entries are before the func entries in the table so the funcs
+        //see the new states of the vars. The derived funcs of the vars and funcs with new states are then updated in the
+        //topological order of the dependency DAG, see rtune_region_compile_dag
+        int i;
+        int next = INT_MAX;
+        for (i = 0; i < region->num_begin_sched; i++) {
+            rtune_sched_t *entry = &region->begin_sched[i];
+            if (entry->next <= count) {
+                if (entry->func == NULL) rtune_sched_var_begin(entry, count);
+                else rtune_sched_func_begin(entry, count);
+            }
+            if (entry->next < next) next = entry->next;
+        }
+        region->next_begin = next;
+        if (region->num_topo_funcs > 0) rtune_region_derive_dirty(region, count);
+    } else if (region->next_begin == INT_MAX && region->next_end == INT_MAX && region->num_due_objs == 0) {
+        region->hot_status &= ~RTUNE_REGION_HOT_TUNING; //nothing will be due anymore, the region is idle until its setup changes
+    }
+    if (region->hot_status & RTUNE_REGION_HOT_APPLY) rtune_region_apply_on_read_vars(region, count);
+}
+
+/**
+ * evaluate an objective whose funcs have new states in this iteration
+ */
+static void rtune_objective_evaluate(rtune_region_t * region, rtune_objective_t *obj, int count) {
+    switch (obj->kind) {
+        case RTUNE_OBJECTIVE_MIN: {
+            //printf("Evaluating min threshold ...: ");
+            //int index = rtune_objective_evaluate_min(obj);
+            //int var_index = obj->input_funcs[0].func->samples.var_index[0][index];
+            //if (index >= 0)
+            //    printf("min objective is met: index: %d, var: %d, func: %.2f\n", index,
+            //           ((short *) (obj->input_funcs[0].func->input_vars[0]->stvar.states))[var_index],
+            //           ((double *) (obj->input_funcs[0].func->stvar.states))[index]);
+
+            rtune_func_t *func = obj->input_funcs[0].func;
+            rtune_var_t * var = func->input_vars[0]; //This should be the same as obj->config[0].var;
+            int index = -1;
+            int var_index = -1;
+
+            if (obj->search_strategy == RTUNE_OBJECTIVE_SEARCH_UNIMODAL_ON_THE_FLY) {
+            	if (func->stvar.num_states < obj->lookup_window) return;
+                printf("########## Evaluating min objective with unimodal on the fly ...: ##################################\n");
+                printf("########## Lookup Window: %d, Fidelity Window: %d ###############################################\n",
+                       obj->lookup_window, obj->fidelity_window);
+                rtune_func_print_doubleFunc_intVar(func, count);
+                index = rtune_objective_min_unimodal_gradient_1var(obj);
+                func->unused_updates = 0;
+                if (index >= 0) {
+                    obj->status = RTUNE_STATUS_OBJECTIVE_MET;
+                    var_index = func->samples.var_index[0][index];
+                    printf("min objective is met: index: %d, var: %d, func: %.2f\n", index,
+                    		rtune_var_get_value(var, var_index)._short_value, rtune_func_get_value(func, index)._double_value);
+                	//apply the variable configuration for the objective that is just met
+                	obj->input_vars[0].value = rtune_var_apply(var, var_index, count);
+                	obj->input_vars[0].var = var;
+                	obj->input_vars[0].index = var_index;
+                	obj->input_vars[0].preference_right = 1;
+                	obj->input_vars[0].last_iteration_applied = count;
+
+                	obj->input_funcs[0].index = index;
+                	obj->input_funcs[0].value = rtune_func_get_value(func, index);
+
+                	//call the callback of the objective
+                	if (obj->callback != NULL) obj->callback(obj, obj->callback_arg);
+                }
+                printf("######################################################################################################\n");
+            } else if (rtune_objective_search_proposes(obj->search_strategy)) {
+                printf("########## Evaluating min objective with %s search ...: ####################################\n",
+                       rtune_objective_search_name(obj->search_strategy));
+                index = rtune_objective_search_1var(obj, 0);
+                func->unused_updates = 0;
+                if (index >= 0) {
+                    obj->status = RTUNE_STATUS_OBJECTIVE_MET;
+                    var_index = func->samples.var_index[0][index];
+                    printf("min objective is met: index: %d, var: %d, func: %.2f\n", index,
+                    		rtune_var_get_value(var, var_index)._short_value, rtune_func_get_value(func, index)._double_value);
+                	//apply the configuration of all the vars of the func for the objective that is just met, which is
+                	//more than one var for the Nelder-Mead search
+                	int j;
+                	for (j = 0; j < func->num_vars && j < obj->num_vars; j++) {
+                	    var_index = func->samples.var_index[j][index];
+                	    obj->input_vars[j].value = rtune_var_apply(func->input_vars[j], var_index, count);
+                	    obj->input_vars[j].var = func->input_vars[j];
+                	    obj->input_vars[j].index = var_index;
+                	    obj->input_vars[j].preference_right = 1;
+                	    obj->input_vars[j].last_iteration_applied = count;
+                	}
+
+                	obj->input_funcs[0].index = index;
+                	obj->input_funcs[0].value = rtune_func_get_value(func, index);
+
+                	//call the callback of the objective
+                	if (obj->callback != NULL) obj->callback(obj, obj->callback_arg);
+                }
+                printf("######################################################################################################\n");
+            } else if (obj->search_strategy == RTUNE_OBJECTIVE_SEARCH_EXHAUSTIVE_AFTER_COMPLETE) {
+                if (func->status != RTUNE_STATUS_UPDATE_COMPLETE ) return;
+                printf("####### Evaluating min objective with exhaustive search after sampling complete ...: #######\n");
+                //index = rtune_objective_evaluate_min_exhaustive_after_complete(obj);
+                utype_t *minValue = &(obj->input_funcs[0].value); //For getting the current min value
+                index = rtune_stvar_find_min(&(func->stvar), 0, func->stvar.num_states, minValue);
+                obj->status = RTUNE_STATUS_OBJECTIVE_MET;
+                func->unused_updates = 0;
+                if (index >= 0) {
+                	var_index = func->samples.var_index[0][index];
+                    printf("min objective is met: index: %d, var: %d, func: %.2f\n", index,
+                    		rtune_var_get_value(var, var_index)._short_value, rtune_func_get_value(func, index)._double_value);
+                }
+            	//apply the variable configuration for the objective that is just met
+            	obj->input_vars[0].value = rtune_var_apply(var, var_index, count);
+            	obj->input_vars[0].var = var;
+            	obj->input_vars[0].index = var_index;
+            	obj->input_vars[0].preference_right = 1;
+            	obj->input_vars[0].last_iteration_applied = count;
+
+            	obj->input_funcs[0].index = index;
+               	obj->input_funcs[0].value = rtune_func_get_value(func, index);
+
+            	//call the callback of the objective
+            	if (obj->callback != NULL) obj->callback(obj, obj->callback_arg);
+                printf("######################################################################################################\n");
+            } else if (obj->search_strategy == RTUNE_OBJECTIVE_SEARCH_EXHAUSTIVE_ON_THE_FLY) {
+                printf("##### Evaluating min objective with exhaustive search on the fly ...: ########\n");
+                utype_t *minValue = &(obj->input_funcs[0].value); //For getting the current min value
+                index = rtune_stvar_find_min(&(func->stvar), rtune_stvar_newest_index(&func->stvar), 1, minValue);
+                func->unused_updates = 0;
+                //index = rtune_objective_evaluate_min_exhaustive_on_the_fly(obj, minValue);
+                if (index >= 0) { //Here we store the temp min in the config and input_funcs
+                	obj->input_funcs[0].index = index;
+                	var_index = func->samples.var_index[0][index];
+                	obj->input_vars[0].value = rtune_var_get_value(var, var_index);
+                	obj->input_vars[0].index = var_index;
+                	obj->input_vars[0].var = var;
+                	obj->input_vars[0].preference_right = 1;
+                	//obj->config[0].last_iteration_applied = count;
+
+                	printf("min objective is met: index: %d, var: %d, func: %.2f\n", index,
+                    		rtune_var_get_value(var, var_index)._short_value, obj->input_funcs[0].value._double_value);
+                }
+                if (func->status == RTUNE_STATUS_UPDATE_COMPLETE) {
+                    obj->status = RTUNE_STATUS_OBJECTIVE_MET;
+                    var_index = obj->input_vars[0].index;
+                	rtune_var_apply(var, var_index, count);
+                	obj->input_vars[0].last_iteration_applied = count;
+                	//apply the variable configuration for the objective that is just met
+
+
+                	//call the callback of the objective
+                	if (obj->callback != NULL) obj->callback(obj, obj->callback_arg);
+                }
+                printf("######################################################################################################\n");
+            } else {
+            	//unsupported min search strategy
+            	printf("unsupported min search strategy\n");
+            }
+            break;
+        }
+        case RTUNE_OBJECTIVE_MAX: {
+            rtune_func_t *func = obj->input_funcs[0].func;
+            rtune_var_t * var = func->input_vars[0]; //This should be the same as obj->config[0].var;
+            int index = -1;
+            int var_index = -1;
+
+            if (obj->search_strategy == RTUNE_OBJECTIVE_SEARCH_UNIMODAL_ON_THE_FLY) {
+            	if (func->stvar.num_states < obj->lookup_window) return;
+                printf("########## Evaluating max objective with unimodal on the fly ...: ##################################\n");
+                printf("########## Lookup Window: %d, Fidelity Window: %d ###############################################\n",
+                       obj->lookup_window, obj->fidelity_window);
+                rtune_func_print_doubleFunc_intVar(func, count);
+                index = rtune_objective_max_unimodal_gradient_1var(obj);
+                func->unused_updates = 0;
+                if (index >= 0) {
+                    obj->status = RTUNE_STATUS_OBJECTIVE_MET;
+                    var_index = func->samples.var_index[0][index];
+                    printf("max objective is met: index: %d, var: %d, func: %.2f\n", index,
+                    		rtune_var_get_value(var, var_index)._short_value, rtune_func_get_value(func, index)._double_value);
+                	//apply the variable configuration for the objective that is just met
+                	obj->input_vars[0].value = rtune_var_apply(var, var_index, count);
+                	obj->input_vars[0].var = var;
+                	obj->input_vars[0].index = var_index;
+                	obj->input_vars[0].preference_right = 1;
+                	obj->input_vars[0].last_iteration_applied = count;
+
+                	obj->input_funcs[0].index = index;
+                	obj->input_funcs[0].value = rtune_func_get_value(func, index);
+
+                	//call the callback of the objective
+                	if (obj->callback != NULL) obj->callback(obj, obj->callback_arg);
+                }
+                printf("######################################################################################################\n");
+            } else if (rtune_objective_search_proposes(obj->search_strategy)) {
+                printf("########## Evaluating max objective with %s search ...: ####################################\n",
+                       rtune_objective_search_name(obj->search_strategy));
+                index = rtune_objective_search_1var(obj, 1);
+                func->unused_updates = 0;
+                if (index >= 0) {
+                    obj->status = RTUNE_STATUS_OBJECTIVE_MET;
+                    var_index = func->samples.var_index[0][index];
+                    printf("max objective is met: index: %d, var: %d, func: %.2f\n", index,
+                    		rtune_var_get_value(var, var_index)._short_value, rtune_func_get_value(func, index)._double_value);
+                	//apply the configuration of all the vars of the func for the objective that is just met, which is
+                	//more than one var for the Nelder-Mead search
+                	int j;
+                	for (j = 0; j < func->num_vars && j < obj->num_vars; j++) {
+                	    var_index = func->samples.var_index[j][index];
+                	    obj->input_vars[j].value = rtune_var_apply(func->input_vars[j], var_index, count);
+                	    obj->input_vars[j].var = func->input_vars[j];
+                	    obj->input_vars[j].index = var_index;
+                	    obj->input_vars[j].preference_right = 1;
+                	    obj->input_vars[j].last_iteration_applied = count;
+                	}
+
+                	obj->input_funcs[0].index = index;
+                	obj->input_funcs[0].value = rtune_func_get_value(func, index);
+
+                	//call the callback of the objective
+                	if (obj->callback != NULL) obj->callback(obj, obj->callback_arg);
+                }
+                printf("######################################################################################################\n");
+            } else if (obj->search_strategy == RTUNE_OBJECTIVE_SEARCH_EXHAUSTIVE_AFTER_COMPLETE) {
+                if (func->status != RTUNE_STATUS_UPDATE_COMPLETE)  return;
+                printf("####### Evaluating max objective with exhaustive search after sampling complete ...: #######\n");
+                //index = rtune_objective_evaluate_min_exhaustive_after_complete(obj);
+                utype_t *maxValue = &(obj->input_funcs[0].value); //For getting the current max value
+                index = rtune_stvar_find_max(&(func->stvar), 0, func->stvar.num_states, maxValue);
+                func->unused_updates = 0;
+                obj->status = RTUNE_STATUS_OBJECTIVE_MET;
+                if (index >= 0) {
+                	var_index = func->samples.var_index[0][index];
+                    printf("max objective is met: index: %d, var: %d, func: %.2f\n", index,
+                    		rtune_var_get_value(var, var_index)._short_value, rtune_func_get_value(func, index)._double_value);
+                }
+            	//apply the variable configuration for the objective that is just met
+            	obj->input_vars[0].value = rtune_var_apply(var, var_index, count);
+            	obj->input_vars[0].var = var;
+            	obj->input_vars[0].index = var_index;
+            	obj->input_vars[0].preference_right = 1;
+            	obj->input_vars[0].last_iteration_applied = count;
+
+            	obj->input_funcs[0].index = index;
+               	obj->input_funcs[0].value = rtune_func_get_value(func, index);
+
+            	//call the callback of the objective
+            	if (obj->callback != NULL) obj->callback(obj, obj->callback_arg);
+                printf("######################################################################################################\n");
+            } else if (obj->search_strategy == RTUNE_OBJECTIVE_SEARCH_EXHAUSTIVE_ON_THE_FLY) {
+                printf("##### Evaluating max objective with exhaustive search on the fly ...: ########\n");
+                utype_t *maxValue = &(obj->input_funcs[0].value); //For getting the current max value
+                index = rtune_stvar_find_max(&(func->stvar), rtune_stvar_newest_index(&func->stvar), 1, maxValue);
+                func->unused_updates = 0;
+                //index = rtune_objective_evaluate_min_exhaustive_on_the_fly(obj, minValue);
+                if (index >= 0) { //Here we store the temp max in the config and input_funcs
+                	obj->input_funcs[0].index = index;
+                	var_index = func->samples.var_index[0][index];
+                	obj->input_vars[0].value = rtune_var_get_value(var, var_index);
+                	obj->input_vars[0].index = var_index;
+                	obj->input_vars[0].var = var;
+                	obj->input_vars[0].preference_right = 1;
+                	//obj->config[0].last_iteration_applied = count;
+
+                	printf("max objective is met: index: %d, var: %d, func: %.2f\n", index,
+                    		rtune_var_get_value(var, var_index)._short_value, obj->input_funcs[0].value._double_value);
+                }
+                if (func->status == RTUNE_STATUS_UPDATE_COMPLETE) {
+                    obj->status = RTUNE_STATUS_OBJECTIVE_MET;
+                    var_index = obj->input_vars[0].index;
+                	rtune_var_apply(var, var_index, count);
+                	obj->input_vars[0].last_iteration_applied = count;
+                	//apply the variable configuration for the objective that is just met
+                	//call the callback of the objective
+                	if (obj->callback != NULL) obj->callback(obj, obj->callback_arg);
+                }
+                printf("######################################################################################################\n");
+            } else {
+            	printf("unsupported max search strategy\n");
+            }
+            break;
+        }
+        case RTUNE_OBJECTIVE_INTERSECTION:
+            break;
+        case RTUNE_OBJECTIVE_THRESHOLD_DOWN:
+            break;
+        case RTUNE_OBJECTIVE_THRESHOLD_UP:
+            break;
+        case RTUNE_OBJECTIVE_SELECT_MIN:
+            break;
+        case RTUNE_OBJECTIVE_SEELCT_MAX:
+            break;
+        case RTUNE_OBJECTIVE_THRESHOLD:
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * stop updating the func if the objectives and derived funcs that use it are all retired, and then its vars and input
+ * funcs if they are not used by others either
+ */
+static void rtune_func_retire_unused(rtune_func_t *func) {
+    if (func->status == RTUNE_STATUS_RETIRED) return;
+    int k;
+    for (k = 0; k < func->num_objs; k++) {
+        if (func->objectives[k]->status != RTUNE_STATUS_RETIRED) return; //check each obj to see whether it is met
+    }
+    for (k = 0; k < func->num_uses; k++) {
+        if (func->usedByFuncs[k]->status != RTUNE_STATUS_RETIRED) return;
+    }
+    func->status = RTUNE_STATUS_RETIRED; //if all users are retired, func update is complete, set it.
+
+    //process each variable of the func
+    for (k = 0; k < func->num_vars; k++) {
+        rtune_var_t *var = func->input_vars[k];
+        if (var->status == RTUNE_STATUS_RETIRED) continue;
+        int l;
+        for (l = 0; l < var->num_uses; l++) {
+            if (var->usedByFuncs[l]->status != RTUNE_STATUS_RETIRED) break;
+        }
+        if (l == var->num_uses) { //if all funcs are retired, var update is complete, set it.
+            var->status = RTUNE_STATUS_RETIRED;
+        }
+    }
+    for (k = 0; k < func->num_input_funcs; k++) rtune_func_retire_unused(func->input_funcs[k]);
+}
+
+/**
+ * process an objective that is just met: apply the metaction and retire the objective, and the funcs and vars that are
+ * only used by retired objectives
+ */
+static void rtune_objective_process_met(rtune_region_t * region, rtune_objective_t *obj) {
+    obj->num_mets++;
+    switch (obj->metaction) {
+        case RTUNE_METACTION_RESET:
+            rtune_objective_reset(obj); //TODO: should we do deep reset or just shallow reset
+            obj->status = RTUNE_STATUS_RESETTED;
+            break;
+        default:
+            break;
+    }
+    if (obj->num_mets == obj->max_num_mets) {
+        obj->status = RTUNE_STATUS_RETIRED; //No need this objective anymore
+        region->num_retired_objs ++;
+        if (region->num_retired_objs == region->num_objs) { //when all objectives are retired, region is retired
+            region->status = RTUNE_STATUS_RETIRED;
+        }
+    }
+
+    int j;
+    for (j=0; j<obj->num_funcs; j++) {
+        rtune_func_t *func = obj->input_funcs[j].func;
+        switch (obj->input_funcs[j].metaction) {
+            case RTUNE_METACTION_RESET:  //If we need to reset the func
+                rtune_func_reset(func);
+                break;
+            default:
+                break;
+        }
+    }
+    for (j=0; j<obj->num_vars; j++) {
+        rtune_var_t *var = obj->input_vars[j].var;
+        if (obj->input_vars[j].applier == NULL) obj->input_vars[j].applier = var->stvar.applier; //keep the applier in the config
+        obj->input_vars[j].ops = var->stvar.ops;
+        obj->input_vars[j].apply_check = var->apply_check; //the value of the config is the one the var just applied
+        switch (obj->input_vars[j].metaction) {
+            case RTUNE_METACTION_RESET:
+                rtune_var_reset(var);
+                break;
+            case RTUNE_METACTION_CONFIG:
+                //apply the applier of the var
+                break;
+            case RTUNE_METACTION_CONFIG_RESET:
+                //apply the applier of the var
+                rtune_var_reset(var);
+                break;
+            default:
+                break;
+        }
+    }
+    if (obj->status != RTUNE_STATUS_RETIRED) return;
+    if (region->status == RTUNE_STATUS_RETIRED) region->hot_status = rtune_region_retired_hot_status(region);
+
+    //Here we need to stop updating the var and func if the objectives that use them all meet
+    for (j = 0; j < obj->num_funcs; j++) rtune_func_retire_unused(obj->input_funcs[j].func);
+}
+
+void rtune_region_end(rtune_region_t * region) {
+    if (region->status == RTUNE_STATUS_RETIRED) return;
+    int count = region->count;
+    int i;
+    region->epoch++;
+
+    //update the states of the funcs that are due in this iteration
+    if (count >= region->next_end) {
+        int next = INT_MAX;
+        for (i = 0; i < region->num_end_sched; i++) {
+            rtune_sched_t *entry = &region->end_sched[i];
+            if (entry->next <= count) rtune_sched_func_end(entry, count);
+            if (entry->next < next) next = entry->next;
+        }
+        region->next_end = next;
+        if (region->num_topo_funcs > 0) rtune_region_derive_dirty(region, count);
+    }
+
+    //check the objectives whose funcs have new states to see whether anyone is met.
+    int num_due_objs = region->num_due_objs;
+    if (num_due_objs == 0) {
+        if (region->next_begin == INT_MAX && region->next_end == INT_MAX)
+            region->hot_status &= ~RTUNE_REGION_HOT_TUNING; //idle until the setup of the region changes
+        return;
+    }
+    rtune_objective_t **due_objs = region->due_objs; //no objective becomes due while they are evaluated
+    for (i = 0; i < num_due_objs; i++) {
+        rtune_objective_t *obj = due_objs[i];
+        if (obj->status == RTUNE_STATUS_RETIRED) continue;
+        rtune_objective_evaluate(region, obj, count);
+    }
+
+    //At this point, all the objectives that are met are applied and in action. TODO: we should apply config/reset action here
+    for (i = 0; i < num_due_objs; i++) {
+        rtune_objective_t *obj = due_objs[i];
+        if (obj->status == RTUNE_STATUS_OBJECTIVE_MET) rtune_objective_process_met(region, obj);
+    }
+    region->num_due_objs = 0;
+}
+
+/**
+ * The designs of the objectives with RTUNE_OBJECTIVE_SEARCH_RANDOM are generated again with the new seed.
+ */
+void rtune_region_set_seed(rtune_region_t * region, uint64_t seed) {
+    int i;
+    region->rng_state = seed;
+    for (i = 0; i < region->num_objs; i++) {
+        rtune_objective_t *obj = region->objs[i];
+        if (obj->search_strategy == RTUNE_OBJECTIVE_SEARCH_RANDOM && obj->num_funcs > 0) rtune_objective_random_setup(obj);
+    }
+}
+
+/**
+ * Reset the retired objectives of the region together with their funcs and vars so the region is tuned again from the next
+ * iteration. The configs of the objectives are kept and applied until the objectives are met again.
+ */
+void rtune_region_rearm(rtune_region_t * region) {
+    int i;
+    for (i = 0; i < region->num_objs; i++) {
+        rtune_objective_t *obj = region->objs[i];
+        if (obj->status != RTUNE_STATUS_RETIRED) continue;
+        rtune_objective_reset_deep(obj);
+        obj->num_mets = 0;
+        if (obj->kind == RTUNE_OBJECTIVE_MIN) set_max(&(obj->input_funcs[0].value), obj->input_funcs[0].func->stvar.type);
+        else if (obj->kind == RTUNE_OBJECTIVE_MAX) set_min(&(obj->input_funcs[0].value), obj->input_funcs[0].func->stvar.type);
+    }
+    region->num_retired_objs = 0;
+    region->status = RTUNE_STATUS_RESETTED;
+    rtune_region_mark_dirty(region);
+}
+
+//OpenMP is not linked to the library, omp_set_num_threads is resolved from the application if it uses OpenMP
+extern void omp_set_num_threads(int num_threads) __attribute__((weak));
+
+static void rtune_omp_set_num_threads(void * num_threads) {
+    omp_set_num_threads((int) (long) num_threads);
+}
+
+/**
+ * add the num_threads var that goes from max_num_threads down to min_num_threads by step, applied via omp_set_num_threads
+ * for each batch, and the exe_time func of the region that accumulates the time of a batch with the built-in timer
+ * @return the exe_time func, NULL if the application does not use OpenMP or the range is invalid
+ */
+static rtune_func_t * rtune_numThreads_exe_time(rtune_region_t * region, short min_num_threads, short max_num_threads, short step, int batch_size) {
+    if (omp_set_num_threads == NULL || step <= 0 || min_num_threads <= 0 || min_num_threads > max_num_threads) return NULL;
+    int begin = max_num_threads;
+    int end = min_num_threads;
+    int range_step = -step;
+    int num_values = (max_num_threads - min_num_threads) / step + 1;
+    rtune_var_t *num_threads = rtune_var_add_range(region, "num_threads", num_values, RTUNE_int, &begin, &end, &range_step);
+    if (num_threads == NULL) return NULL;
+    rtune_var_set_applier_policy(num_threads, rtune_omp_set_num_threads, RTUNE_VAR_APPLY_ON_UPDATE);
+    rtune_var_set_update_schedule_attr(num_threads, RTUNE_UPDATE_REGION_BEGIN, RTUNE_UPDATE_LIST_SERIES, 0, batch_size, 0);
+
+    rtune_func_t *exe_time = rtune_func_add_model(region, RTUNE_FUNC_EXT_DIFF, "exe_time", RTUNE_double, RTUNE_TIMER_NS, NULL, 1, num_threads);
+    if (exe_time == NULL) return NULL;
+    rtune_func_set_update_schedule_attr(exe_time, RTUNE_UPDATE_REGION_BEGIN_END_DIFF, RTUNE_UPDATE_BATCH_ACCUMULATE, RTUNE_DEFAULT_NONE, RTUNE_DEFAULT_NONE, RTUNE_DEFAULT_NONE);
+    return exe_time;
+}
+
+/**
+ * set the search strategy and fidelity of a num_threads objective: exhaustive for a few thread counts and the given
+ * strategy for many, and small batches are given a higher deviation tolerance for their noise
+ */
+static void rtune_numThreads_search_attr(rtune_objective_t * obj, int num_values, int batch_size, rtune_objective_attribute_t search_strategy) {
+    float deviation_tolerance = batch_size >= 5 ? 0.05 : DEFAULT_deviation_tolerance;
+    rtune_objective_set_search_strategy(obj, num_values <= DEFAULT_numThreads_max_exhaustive ?
+        RTUNE_OBJECTIVE_SEARCH_EXHAUSTIVE_ON_THE_FLY : search_strategy);
+    rtune_objective_set_fidelity_attr(obj, deviation_tolerance, DEFAULT_fidelity_window, DEFAULT_lookup_window);
+}
+
+/**
+ * The objective to find the number of OpenMP threads with the least execution time of the region. The num_threads var goes
+ * from max_num_threads down to min_num_threads by step and is applied via omp_set_num_threads for each batch of update_rate
+ * iterations, in which the execution time of the region is accumulated with the built-in timer. The search is exhaustive
+ * for a few thread counts. For many, the exe time is modeled with the Universal Scalability Law from a few thread counts
+ * spread over the range, and only the thread counts around the optimum it predicts are sampled to confirm it.
+ * @return the objective, NULL if the application does not use OpenMP or the range is invalid
+ */
+rtune_objective_t * rtune_objective_perf_numThreads(rtune_region_t * region, short min_num_threads, short max_num_threads, short step, int update_rate) {
+    int batch_size = update_rate > 0 ? update_rate : DEFAULT_numThreads_batch_size;
+    rtune_func_t *exe_time = rtune_numThreads_exe_time(region, min_num_threads, max_num_threads, step, batch_size);
+    if (exe_time == NULL) return NULL;
+    rtune_objective_t *obj = rtune_objective_add_min(region, "min exe time", exe_time);
+    if (obj == NULL) return NULL;
+    rtune_numThreads_search_attr(obj, exe_time->stvar.total_num_states, batch_size, RTUNE_OBJECTIVE_SEARCH_MODEL);
+    return obj;
+}
+
+/**
+ * a callback of the objective of rtune_objective_weak_numThreads_size that prints the parallel efficiency of the num_threads
+ * found, which is opt-in via rtune_objective_add_callback(obj, rtune_objective_print_scalability, NULL)
+ */
+void rtune_objective_print_scalability(rtune_objective_t * obj, void * arg) {
+    (void) arg;
+    rtune_func_t *efficiency = obj->input_funcs[0].func;
+    int index = obj->input_funcs[0].index;
+    if (index < 0) return;
+    printf("weak scaling objective %s is met: num_threads: %d, parallel efficiency: %.2f\n", obj->name,
+           (int) rtune_column_double(rtune_func_column_var(efficiency, 0), index), rtune_calcuate_scalability(efficiency, index));
+}
+
+/**
+ * The objective to find the number of OpenMP threads with the most throughput per thread of the region, whose work size
+ * is read from problem_size in each iteration. It is rtune_objective_perf_numThreads with the exe_time turned into the
+ * parallel efficiency problem_size/(exe_time*num_threads), so the samples taken with different problem sizes are comparable.
+ * Only the thread count is tuned, the problem size is observed as the application sets it. No callback is set, the
+ * parallel efficiency of the num_threads found is given by rtune_calcuate_scalability, or printed with the
+ * rtune_objective_print_scalability callback.
+ * @return the objective, NULL if the application does not use OpenMP or the range is invalid
+ */
+rtune_objective_t * rtune_objective_weak_numThreads_size(rtune_region_t * region, short min_num_threads, short max_num_threads, short step, long * problem_size, int update_rate) {
+    int batch_size = update_rate > 0 ? update_rate : DEFAULT_numThreads_batch_size;
+    rtune_func_t *exe_time = rtune_numThreads_exe_time(region, min_num_threads, max_num_threads, step, batch_size);
+    if (exe_time == NULL || problem_size == NULL) return NULL;
+    rtune_var_t *num_threads = exe_time->input_vars[0];
+
+    //the problem size is sampled in each iteration, only its latest value is needed
+    rtune_var_t *size = rtune_var_add_ext(region, "problem_size", DEFAULT_FUNC_SAMPLE_CAPACITY, RTUNE_long, (void *(*)(void *)) problem_size, problem_size);
+    if (size == NULL) return NULL;
+    rtune_stvar_set_trace_mode(size, RTUNE_TRACE_RING);
+    rtune_var_set_update_schedule_attr(size, RTUNE_UPDATE_REGION_BEGIN, RTUNE_UPDATE_BATCH_STRAIGHT, 0, 1, 0);
+
+    rtune_func_t *efficiency = rtune_func_add_efficiency(region, "efficiency", exe_time, num_threads, size);
+    if (efficiency == NULL) return NULL;
+    rtune_objective_t *obj = rtune_objective_add_max(region, "max efficiency", efficiency);
+    if (obj == NULL) return NULL;
+    rtune_numThreads_search_attr(obj, exe_time->stvar.total_num_states, batch_size, RTUNE_OBJECTIVE_SEARCH_UNIMODAL_ON_THE_FLY);
+    return obj;
+}
+
+/**
+ * The objective to find the CPU frequency with the least energy of the region. The frequency var goes from max_freq down
+ * to min_freq by step (kHz) and is applied via cpufreq for each batch of update_rate iterations, in which the RAPL energy
+ * of the region is accumulated.
+ * @return the objective, NULL if the energy cannot be read or the frequency cannot be set, see rtune_sysfs_set_root
+ */
+rtune_objective_t * rtune_objective_energy_cpuFrequency(rtune_region_t * region, unsigned long min_freq, unsigned long max_freq, unsigned long step, int update_rate) {
+    if (step == 0 || min_freq > max_freq || update_rate <= 0) return NULL;
+    rtune_energy_t *energy = rtune_energy_add(region);
+    if (energy == NULL || rtune_cpufreq_init() == 0) return NULL;
+
+    long freq_begin = max_freq;
+    long freq_end = min_freq;
+    long freq_step = -(long) step;
+    int num_freqs = (max_freq - min_freq) / step + 1;
+    rtune_var_t *cpu_freq = rtune_var_add_range(region, "cpu_frequency", num_freqs, RTUNE_long, &freq_begin, &freq_end, &freq_step);
+    if (cpu_freq == NULL) return NULL;
+    rtune_var_set_applier_policy(cpu_freq, rtune_cpufreq_apply, RTUNE_VAR_APPLY_ON_UPDATE);
+    rtune_var_set_update_schedule_attr(cpu_freq, RTUNE_UPDATE_REGION_BEGIN, RTUNE_UPDATE_LIST_SERIES, 0, update_rate, 0);
+
+    rtune_func_t *energy_func = rtune_func_add_model(region, RTUNE_FUNC_EXT_DIFF, "energy", RTUNE_double, RTUNE_ENERGY, energy, 1, cpu_freq);
+    if (energy_func == NULL) return NULL;
+    rtune_func_set_update_schedule_attr(energy_func, RTUNE_UPDATE_REGION_BEGIN_END_DIFF, RTUNE_UPDATE_BATCH_ACCUMULATE, RTUNE_DEFAULT_NONE, RTUNE_DEFAULT_NONE, RTUNE_DEFAULT_NONE);
+    return rtune_objective_add_min(region, "min energy", energy_func);
+}
+
+/**
+ * The parallel efficiency of a sample of an efficiency func relative to the sample with the fewest threads, which is the
+ * baseline of the scaling. As the efficiency is the throughput per thread, this is 1.0 for perfect weak/strong scaling.
+ * @return the parallel efficiency, 0.0 if index is not a sample or the baseline has no throughput
+ */
+float rtune_calcuate_scalability(rtune_func_t * efficiency, int index) {
+    if (efficiency->kind != RTUNE_FUNC_EFFICIENCY || index < 0 || index >= efficiency->stvar.num_states) return 0.0;
+    rtune_column_t threads = rtune_func_column_var(efficiency, 0);
+    double *values = (double *) efficiency->stvar.states;
+    int base = 0;
+    int i;
+    for (i = 1; i < efficiency->stvar.num_states; i++) {
+        if (rtune_column_double(threads, i) < rtune_column_double(threads, base)) base = i;
+    }
+    return values[base] > 0 ? values[index] / values[base] : 0.0;
 }
 
 #if 0
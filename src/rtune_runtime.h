@@ -2,14 +2,20 @@
 #define RTUNE_RUNTIME_H
 
 #include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
 //#include "rtune_config.h"
 //#include "rtune.h"
 
-#define MAX_NUM_REGIONS 16
-#define MAX_NUM_VARS 8
-#define MAX_NUM_FUNCS 8
+#define DEFAULT_NUM_REGION_SLOTS 64 //initial number of slots of the region registry, which grows on demand
+#define DEFAULT_NUM_FREE_REGIONS 16 //max number of finalized regions kept with their arena to be reused, more are freed
+#define DEFAULT_REGION_ARENA_SIZE 16384 //initial size in bytes of the arena of a region, which grows on demand
+#define DEFAULT_EWMA_alpha 0.2
+#define DEFAULT_batch_trim_ratio 0.1 //ratio of the values trimmed from each end of a batch for RTUNE_UPDATE_BATCH_TRIMMED_MEAN
+#define DEFAULT_FUNC_SAMPLE_CAPACITY 16 //initial number of samples the sample store of a func holds, which grows on demand
+#define RTUNE_CACHE_LINE_SIZE 64
+#define DEFAULT_NUM_REGION_ENTRIES 8 //initial capacity of the var/func/objective arrays of a region, which grow on demand
 #define MAX_NUM_MODELS 8
-#define MAX_NUM_OBJ 8
 
 typedef enum rtune_data_type {
     RTUNE_short,
@@ -44,14 +50,18 @@ typedef enum rtune_kind {
     RTUNE_FUNC_THRESHOLD,
     RTUNE_FUNC_DISTANCE,
     RTUNE_FUNC_GRADIENT,
+    RTUNE_FUNC_EFFICIENCY, //work / (time * threads) from an exe time func, see rtune_func_add_efficiency
+    RTUNE_FUNC_RATIO,
+    RTUNE_FUNC_PRODUCT,
     RTUNE_FUNC_EXT,
     RTUNE_FUNC_EXT_DIFF,
     //For models, which are function with unknown or un-modeled function.
     RTUNE_MODEL,
-    RTUNE_MODEL_LINEAR,
-    RTUNE_MODEL_QUADRATIC,
+    RTUNE_MODEL_LINEAR, //y = params[0] + params[1]*x, see rtune_model_t
+    RTUNE_MODEL_QUADRATIC, //y = params[0] + params[1]*x + params[2]*x^2
     RTUNE_MODEL_IMPLICIT,
-    RTUNE_MODEL_UNIMODAL,
+    RTUNE_MODEL_UNIMODAL, //fitted as RTUNE_MODEL_QUADRATIC, whose vertex is the single min/max
+    RTUNE_MODEL_USL, //Universal Scalability Law of the exe time over the number of threads, see rtune_model_t
 } rtune_kind_t;
 
 /**
@@ -86,10 +96,16 @@ typedef enum rtune_var_update_kind {
     RTUNE_UPDATE_BATCH_STRAIGHT, //update once for each batch
     RTUNE_UPDATE_BATCH_ACCUMULATE,  //calculate for each iteration of the batch at the specified time/location (BEGIN and/or END) and
                                     //accumulate together as one update
+    //batch reducers: collect a value for each iteration of the batch as accumulate does, and reduce them into one update
+    //that is robust to outliers. The dispersion of the batch is recorded for each update, see stvar_t::dispersion
+    RTUNE_UPDATE_BATCH_MEDIAN,       //the median, the dispersion is the median absolute deviation
+    RTUNE_UPDATE_BATCH_TRIMMED_MEAN, //the mean without the DEFAULT_batch_trim_ratio lowest and highest values, the dispersion is their stddev
+    RTUNE_UPDATE_BATCH_MIN,          //the min, the dispersion is the stddev
+    RTUNE_UPDATE_BATCH_MEAN_STDDEV,  //the mean, the dispersion is the stddev
 
     //update policy for list and range values
-    RTUNE_UPDATE_LIST_RANDOM, //random pick a value from list/range
-    RTUNE_UPDATE_LIST_RANDOM_UNIQUE, //random pick but unique
+    RTUNE_UPDATE_LIST_RANDOM, //random pick a value from list/range with the RNG of the region, see rtune_region_set_seed
+    RTUNE_UPDATE_LIST_RANDOM_UNIQUE, //random pick but unique, i.e. a random permutation of the values drawn one by one
     RTUNE_UPDATE_LIST_SERIES,  //pick value one by one based on the list/range order for one round only
     RTUNE_UPDATE_LIST_SERIES_CYCLIC, //pick value one by one based on the list/range order, cycling after a round
     RTUNE_UPDATE_LIST_FOLLOW_OBJECTIVE, //according to the convergence of the objective of the objective function that uses this variable.
@@ -114,6 +130,20 @@ typedef union unified_type {
     void * _typed_value;
 } utype_t;
 
+/**
+ * State to skip a redundant call of an applier for RTUNE_VAR_APPLY_ON_READ. The applier is skipped if the reader reads back
+ * the value to apply from the caller env, or, without a reader, if the same value was applied and the generation counter
+ * has not been increased since. Without a reader and a generation counter, the applier is always called.
+ */
+typedef struct rtune_apply_check {
+    void *(*reader) (void *); //optional, read the value in effect in the caller env, e.g. omp_get_max_threads for omp_set_num_threads
+    void *reader_arg;
+    const volatile unsigned long *generation; //optional, a counter increased by whoever changes the value outside rtune, not by the applier
+    unsigned long applied_generation; //the generation just before the value was applied
+    utype_t applied_value;
+    int applied; //whether applied_value was applied
+} rtune_apply_check_t;
+
 typedef enum rtune_objective_kind {
     RTUNE_OBJECTIVE_MIN,
     RTUNE_OBJECTIVE_MAX,
@@ -142,17 +172,32 @@ typedef enum rtune_objective_attribute {
     RTUNE_OBJECTIVE_SEARCH_EXHAUSTIVE_AFTER_COMPLETE,
     RTUNE_OBJECTIVE_SEARCH_EXHAUSTIVE_ON_THE_FLY,
     RTUNE_OBJECTIVE_SEARCH_UNIMODAL_ON_THE_FLY,
-    RTUNE_OBJECTIVE_SEARCH_RANDOM,
-    RTUNE_OBJECTIVE_SEARCH_NELDER_MEAD, //simplex method
-    RTUNE_OBJECTIVE_SEARCH_BINARY_GRADIENT,
-    RTUNE_OBJECTIVE_SEARCH_QUATERNARY_GRADIENT,
-    RTUNE_OBJECTIVE_SEARCH_OCTAL_GRADIENT,
+    RTUNE_OBJECTIVE_SEARCH_RANDOM, //sample the configs of a design over all the list/range vars of the func, e.g. a Sobol sequence
+                                   //or a Latin hypercube (see rtune_objective_set_design), and take the best of them
+    RTUNE_OBJECTIVE_SEARCH_NELDER_MEAD, //simplex method over all the list/range vars of the func, which are applied together as a config
+    RTUNE_OBJECTIVE_SEARCH_BINARY_GRADIENT, //k-ary gradient search of a list/range var, k is 2, 4, 8 and 16, which narrows the bracket
+    RTUNE_OBJECTIVE_SEARCH_QUATERNARY_GRADIENT, //of the optimum to 1/k in each round by the gradients at the k-1 points
+    RTUNE_OBJECTIVE_SEARCH_OCTAL_GRADIENT,      //that split the bracket
     RTUNE_OBJECTIVE_SEARCH_HEX_GRADIENT,
+    RTUNE_OBJECTIVE_SEARCH_MODEL, //fit the model of the func (see rtune_func_set_model) to a few samples spread over the values of
+                                  //its var, then only sample around the optimum the model predicts to confirm it
+    RTUNE_OBJECTIVE_SEARCH_GOLDEN_SECTION, //Fibonacci search, i.e. golden-section search on the grid of a list/range var, which
+                                           //brackets the optimum of a unimodal func in O(log n) samples of its n values
     //The inhouse binary gradient approach: given a known number of sorted input (x1,x2,...x0,...,xn) for a variable X,
     //x0 is the value in the middle, collect f(x1) (or f(xn)) and f(x0), calculate the gradient g(x1->x0) = (f(x0) - f(x1))/(x0 - x1).
     //For minization, if g(x1->x0) > 0;
 } rtune_objective_attribute_t;
 
+/**
+ * Designs of the configs RTUNE_OBJECTIVE_SEARCH_RANDOM samples, see rtune_design_generate
+ */
+typedef enum rtune_design {
+    RTUNE_DESIGN_RANDOM,          //uniform random configs
+    RTUNE_DESIGN_LATIN_HYPERCUBE, //each of the N strata of the values of each var is sampled once by the N configs
+    RTUNE_DESIGN_SOBOL,           //the low-discrepancy Sobol sequence, for up to RTUNE_DESIGN_MAX_DIMS vars
+} rtune_design_t;
+#define RTUNE_DESIGN_MAX_DIMS 8
+
 /**
  * common actions for events such as objective is met, a var or func is updated
  */
@@ -170,6 +215,20 @@ typedef enum rtune_action {
 #define DEFAULT_fidelity_window 2
 #define DEFAULT_lookup_window 4
 
+// For models: the r2 a fit needs to be trusted to predict the optimum, see rtune_model_t
+#define DEFAULT_model_r2_threshold 0.9
+
+// For RTUNE_OBJECTIVE_SEARCH_NELDER_MEAD: the number of configs the search samples at most for each input var of the func
+#define DEFAULT_nelder_mead_samples_per_var 32
+
+// For RTUNE_OBJECTIVE_SEARCH_RANDOM: the number of configs of the design for each input var of the func
+#define DEFAULT_random_samples_per_var 16
+
+// For rtune_objective_perf_numThreads: the batch size if update_rate is not given, and the max number of thread counts that are
+// searched exhaustively, more than that are searched with a model (USL), or as unimodal for rtune_objective_weak_numThreads_size
+#define DEFAULT_numThreads_batch_size 10
+#define DEFAULT_numThreads_max_exhaustive 8
+
 // For variables and functions
 #define DEFAULT_update_iteration_start 0
 #define DEFAULT_batch_size 1
@@ -188,6 +247,88 @@ typedef enum rtune_action {
  * stvar stands for state trace variable, introduced for a system to keep track of its state change that can be used for other purpose
  * such as analyzing the trend of the change for building models.
  */
+/**
+ * how the states of a var/func are kept. A flat trace keeps the first total_num_states states and drops the states after
+ * it is full. A ring trace keeps the last total_num_states states with a fixed memory footprint, the newest state
+ * overwrites the oldest one once it is full, and the var/func never completes its update.
+ */
+typedef enum rtune_trace_mode {
+    RTUNE_TRACE_FLAT,
+    RTUNE_TRACE_RING,
+} rtune_trace_mode_t;
+
+/**
+ * How the value of an ext var/func is read from its provider. A built-in provider, e.g. RTUNE_TIMER_NS, is recognized when
+ * the var/func is added and read inline by the runtime rather than called through the provider function pointer.
+ */
+typedef enum rtune_provider_kind {
+    RTUNE_PROVIDER_NONE,    //no provider, the values are the list/range values of the var
+    RTUNE_PROVIDER_POINTER, //the provider is a pointer to the application variable
+    RTUNE_PROVIDER_FUNC,    //the provider is a user function called with the provider_arg
+    RTUNE_PROVIDER_TIMER_NS,     //rtune_timer_ns, monotonic raw time in nanoseconds
+    RTUNE_PROVIDER_TIMER_MS,     //rtune_timer_ms, monotonic raw time in milliseconds
+    RTUNE_PROVIDER_TIMER_CYCLES, //rtune_timer_cycles, invariant TSC cycles
+    RTUNE_PROVIDER_PERF_COUNTER, //rtune_perf_counter_read, a counter of the perf_event group of the region
+    RTUNE_PROVIDER_RUSAGE,       //rtune_rusage_read, a resource usage field of the process
+    RTUNE_PROVIDER_ENERGY,       //rtune_energy_read, RAPL energy of the packages
+} rtune_provider_kind_t;
+
+/**
+ * Events of the perf_event provider, see rtune_perf_counter_add. A hardware event that cannot be opened, e.g. in a VM
+ * without a virtual PMU, falls back to its software counterpart if it has one, otherwise the counter reads 0.
+ */
+typedef enum rtune_perf_event {
+    //hardware events
+    RTUNE_PERF_CYCLES, //falls back to RTUNE_PERF_TASK_CLOCK
+    RTUNE_PERF_INSTRUCTIONS,
+    RTUNE_PERF_CACHE_REFERENCES,
+    RTUNE_PERF_LLC_MISSES,
+    RTUNE_PERF_BRANCH_MISSES,
+    //software events
+    RTUNE_PERF_TASK_CLOCK, //nanoseconds on CPU
+    RTUNE_PERF_CONTEXT_SWITCHES,
+    RTUNE_PERF_PAGE_FAULTS,
+    RTUNE_PERF_CPU_MIGRATIONS,
+    RTUNE_PERF_NUM_EVENTS,
+} rtune_perf_event_t;
+
+typedef struct rtune_perf_counter rtune_perf_counter_t;
+
+/**
+ * Resource usage fields of the process for the rusage provider, see rtune_rusage_add. The RUSAGE fields are from getrusage
+ * and the PROC fields from /proc/self/stat.
+ */
+typedef enum rtune_rusage_field {
+    RTUNE_RUSAGE_MAX_RSS,          //max resident set size in KB
+    RTUNE_RUSAGE_MINOR_FAULTS,
+    RTUNE_RUSAGE_MAJOR_FAULTS,
+    RTUNE_RUSAGE_VOLUNTARY_CSW,    //voluntary context switches
+    RTUNE_RUSAGE_INVOLUNTARY_CSW,  //involuntary context switches
+    RTUNE_RUSAGE_USER_TIME,        //user CPU time in ms
+    RTUNE_RUSAGE_SYSTEM_TIME,      //system CPU time in ms
+    RTUNE_PROC_RSS,                //current resident set size in KB
+    RTUNE_PROC_VSIZE,              //virtual memory size in KB
+    RTUNE_PROC_NUM_THREADS,
+    RTUNE_RUSAGE_NUM_FIELDS,
+} rtune_rusage_field_t;
+
+typedef struct rtune_rusage_counter rtune_rusage_counter_t;
+typedef struct rtune_energy rtune_energy_t;
+
+/**
+ * Streaming statistics of all the states a var/func has been updated with, including those dropped by a full flat trace
+ * or overwritten in a ring trace. They are updated in O(1) with each new state, the variance with Welford's method.
+ */
+typedef struct rtune_stats {
+    long count;
+    double mean;
+    double m2; //sum of squares of the differences from the mean, variance is m2/(count-1)
+    double min;
+    double max;
+    double ewma; //exponentially weighted moving average
+    double ewma_alpha; //weight of the newest state for the ewma
+} rtune_stats_t;
+
 typedef struct stvar {//The base of var, func and model
     //current value. type cast are needed to read or write from this location. This is the first field such
     //that one can use the pointer to read/write the value of the variable just like a regular variable.
@@ -196,6 +337,7 @@ typedef struct stvar {//The base of var, func and model
     char *name; //a meaningful name
     //an independent variable, dependent variable (func), or model since the way we list the kind in the list declaration defined before.
     rtune_data_type_t type; //var data type such as int, short, float, double
+    const struct rtune_stvar_ops *ops; //the ops specialized for the type, which are bound when the var/func is created
     void *states; //sampled values of this variables. /opaque typed-array, element type is determined by type
     int num_states;       //the current number of states
     int total_num_states; //total number of states to have
@@ -208,6 +350,7 @@ typedef struct stvar {//The base of var, func and model
 
     void *(*provider) (void *);
     void * provider_arg;  //The corresponding application variable if provided, or a function that can be called to read the value
+    rtune_provider_kind_t provider_kind;
 
     utype_t accu4Begin_or_base4Diff; //for ext vars/funcs that need to be accumulated at the BEGINing of the
                                     //region across iterations, this is the accumulator var. For the diff vars/funcs, this is to store
@@ -215,6 +358,16 @@ typedef struct stvar {//The base of var, func and model
     utype_t accu4End_or_accu4Diff;  //for ext vars/funcs that need to be accumulated at the END of the
                                    //region across iterations, this is the accumulator var. For the diff vars/funcs,
                                    //this is the accumulator var to store the diff accumulated across iterations.
+
+    double *batch_values; //values collected in the current batch by a batch reducer, allocated for batch_capacity values
+    int num_batch_values;
+    int batch_capacity;
+    double *dispersion; //the dispersion of the batch each state is reduced from, indexed as states, NULL unless a batch reducer is used
+
+    rtune_trace_mode_t trace_mode;
+    long num_updates; //number of states the stvar has been updated with, which is greater than num_states once the trace is full
+    int last_index;   //index of the newest state in states, -1 if it is dropped
+    rtune_stats_t stats;
 } stvar_t;
 
 /**
@@ -250,21 +403,25 @@ typedef struct rtune_var {
     int update_iteration_start; //When the initial sample is collected, which is the sampling_init_iteration count of the rtune_region iteration
     int batch_size;      //The amount of iterations for each update of the variable or for each collection of the sample
     int update_iteration_stride;    //The number of iterations between each sample
+    int sched_origin; //the iteration the update schedule counts from, which is the iteration after the var is resetted, 0 by default
+    struct rtune_region *region; //the region this var belongs to
 
     int current_apply_index;
     int last_apply_iteration;
     rtune_var_apply_policy_t apply_policy;
+    rtune_apply_check_t apply_check;
 
     int num_uses; //number of functions that use this var
-    struct rtune_func *usedByFuncs[MAX_NUM_VARS]; /* the func/model that directly use this variable as its input */
-
-    //struct rtune_objective *objs[MAX_NUM_OBJ];
-    //int num_objs;
+    int max_uses; //capacity of usedByFuncs
+    struct rtune_func **usedByFuncs; /* the func/model that directly use this variable as its input */
 
     //list and var-specific fields
     int num_unique_values; //number of unique values can be set for the variable, useful for list and range var
     int *count_value;      //The count of each unique value the variable is set as;
     int current_v_index; //The index of the current value in the list or the range
+    int proposed_v_index; //The index of the value proposed by the objective for RTUNE_UPDATE_LIST_FOLLOW_OBJECTIVE, -1 if none
+    int *random_order; //for RTUNE_UPDATE_LIST_RANDOM_UNIQUE, a permutation of the value indices whose first num_random_drawn are drawn
+    int num_random_drawn;
     int update_direction; //left or right. This is used by the objective to tell how list/range var should be updated
     union list_range_setting { //setting for independent-var of list or range
         struct list_var {
@@ -280,6 +437,62 @@ typedef struct rtune_var {
     }list_range_setting;
 } rtune_var_t;
 
+/**
+ * The columnar sample store of a func. The i-th row of every column is the i-th sample of the func, whose func value is
+ * the i-th state of the func (stvar.states is the func value column). The columns are contiguous, cache-line aligned and
+ * allocated from the region arena. They grow with the states as samples are appended, instead of being allocated for the
+ * product of the number of states of all the input vars up front.
+ */
+typedef struct rtune_samples {
+    int capacity;     //number of rows the columns (and the states of the func) are allocated for
+    int *iteration;   //the iteration count when each sample is recorded
+    int **var_index;  //a column for each input var, the index of the state of the var for each sample, -1 if the var has no state yet
+    void **var_value; //a column for each input var, the value of the var for each sample, of the type of the var
+} rtune_samples_t;
+
+/**
+ * A read-only view of a column of the sample store of a func. No data is copied to create a view, and a view is valid
+ * until the next sample is appended to the func since the columns may be moved when they grow.
+ */
+typedef struct rtune_column {
+    const void *data;
+    rtune_data_type_t type;
+    int length;
+} rtune_column_t;
+
+#define RTUNE_COLUMN_VALUE(TYPE, column, i) (((const TYPE *) (column).data)[i])
+#define RTUNE_COLUMN_ITERATION(column, i) RTUNE_COLUMN_VALUE(int, column, i)
+
+#define RTUNE_MODEL_MAX_PARAMS 3
+
+/**
+ * A model of a func over its first input var x, y = sum of params[i] * features[i](x), fitted by online least squares
+ * on the samples of the func. The normal equations are accumulated with each sample, so a fit is O(1) in the number
+ * of samples. For RTUNE_MODEL_USL, y is the exe time T of N = x threads, and the model is fitted in the linear form
+ * T*N = params[0] + params[1]*(N-1) + params[2]*N*(N-1), i.e. the serial time, and the contention and the coherency
+ * cost of the Universal Scalability Law scaled by it. For the linear and quadratic models, x is normalized to
+ * (x - x_shift) / x_scale in the features to keep the normal equations well-conditioned, see rtune_model_set_domain.
+ *
+ * A fit is only trusted to predict the optimum (modeled) when it has more samples than params, i.e. it is not just
+ * interpolating the samples, and its r2 passes r2_threshold.
+ */
+typedef struct rtune_model {
+    rtune_kind_t kind;
+    int num_params;
+    double x_shift;
+    double x_scale;
+    double r2_threshold; //DEFAULT_model_r2_threshold by default
+    int num_samples;
+    double xtx[RTUNE_MODEL_MAX_PARAMS][RTUNE_MODEL_MAX_PARAMS]; //sum of features * features^T of the samples
+    double xty[RTUNE_MODEL_MAX_PARAMS]; //sum of features * y of the samples
+    double yty; //sum of y * y of the samples
+    double sum_y;
+    double params[RTUNE_MODEL_MAX_PARAMS];
+    double r2; //coefficient of determination of the fit (of T*N for USL)
+    int fitted; //1 if the params are determined by the samples, e.g. USL needs samples of three thread counts
+    int modeled; //1 if the fit is trusted to predict the optimum
+} rtune_model_t;
+
 /**
  * struct for objective function
  */
@@ -292,20 +505,36 @@ typedef struct rtune_func {
     int update_iteration_start; //When the initial sample is collected, which is the sampling_init_iteration count of the rtune_region iteration
     int batch_size;      //how many iterations to update the variable and collect the sample
     int update_iteration_stride;    //The number of iterations between 0each sample
+    int sched_origin; //the iteration the update schedule counts from, which is the iteration after the func is resetted, 0 by default
+    struct rtune_region *region; //the region this func belongs to
 
     rtune_var_t *active_var; //the variable which is being updated
 
-    rtune_var_t *input_vars[MAX_NUM_VARS]; /* the input var and coefficient this variable */
+    rtune_var_t **input_vars; /* the input var and coefficient this variable */
     int num_vars;
-    utype_t input_coefs[MAX_NUM_VARS];
+    utype_t *input_coefs;
     int num_coefs;
 
-    int *input; //The input of var values represented by the index of the state of each variable.
-                //This is a 2-D array of int [total_num_states][num_vars]
+    rtune_samples_t samples; //the input var values and iteration of each state of the func, by column
+    rtune_model_t *model; //the model fitted to the samples over the first input var, NULL if not modeled
+
+    //a derived func (RTUNE_FUNC_LOG to RTUNE_FUNC_PRODUCT) is not scheduled, it is updated from the new states of its
+    //operands by the evaluation engine, see rtune_func_add
+    stvar_t **operands; //the inputs of a derived func in the order of the operation, each is the stvar of a var or a func
+    int num_operands;
+    int *operand_columns; //for each operand, the column of the input var of the first func operand it is read from, or RTUNE_OPERAND_FUNC/RTUNE_OPERAND_VALUE
+    long num_derived; //the number of updates of the func operands (or of the var operands) the derived func is updated with
+    int topo_index; //the index of the derived func in region->topo_funcs, -1 until the region is compiled with it
+    struct rtune_func **input_funcs; //the func operands
+    int num_input_funcs;
+    struct rtune_func **usedByFuncs; //the derived funcs that use this func as input
+    int num_uses;
+    int max_uses;
 
     //Objectives that use this function
-    struct rtune_objective *objectives[MAX_NUM_OBJ];
+    struct rtune_objective **objectives;
     int num_objs;
+    int max_objs; //capacity of objectives
 
     int unused_updates;
 } rtune_func_t;
@@ -320,6 +549,7 @@ typedef struct rtune_func {
  */
 typedef struct rtune_objective {
     char * name; //a meaningful name
+    struct rtune_region *region; //the region this objective belongs to
     rtune_objective_kind_t kind;
     int max_num_mets;   //An objective can be met multiple times, this set the max number of mets an objective is allowed
                         //By default, this max is 1, meaning when an objective is met, it is over, -1 is for unlimited mets.
@@ -328,6 +558,9 @@ typedef struct rtune_objective {
     void (*callback) (struct rtune_objective*, void *);             //callback when the objective is met, or when the objective is used,
     void *callback_arg;
     rtune_objective_attribute_t search_strategy; //when the obj should be evaluated, after the funcs are completed updated or while they are being updated
+    rtune_design_t design; //the design of RTUNE_OBJECTIVE_SEARCH_RANDOM, see rtune_objective_set_design
+    int num_design_configs; //number of configs of the design, 0 for DEFAULT_random_samples_per_var for each var
+    int *design_configs; //the value index of each var for each config, num_design_configs rows of func->num_vars
     rtune_action_t metaction; //What action to take when the objectve is met
     float deviation_tolerance; /* absolute deviation tolerance */
     int fidelity_window; /* consequent number of occurrence of meeting the objective goal to accept that the objective is met */
@@ -349,8 +582,9 @@ typedef struct rtune_objective {
         rtune_var_apply_policy_t apply_policy;  //XXX: Not sure whether we need this objective-specific var apply policy since if each var is independently applied, it has its own apply_policy. We need this 
                                                 //only if there is situation that we need apply a var differently according to the different objectives that use the var
         void (*applier) (void *); //applier is a function that take the var value as arg to apply the var to the caller env
-
-    } input_vars[MAX_NUM_VARS];
+        const struct rtune_stvar_ops *ops; //of the var type, to read back and compare the applied value
+        rtune_apply_check_t apply_check;
+    } *input_vars;
     int num_vars; //num of independent variables that impact the objective func, thus the objective
 
     //This is used to store the actual value of the functions when the objective is met.
@@ -359,39 +593,108 @@ typedef struct rtune_objective {
     	utype_t value;
     	int index; //
         rtune_action_t metaction;
-    } input_funcs[MAX_NUM_VARS];
+    } *input_funcs;
     int num_funcs;                    //num of models in the input
 
     struct input_coefs {
     	utype_t coef;
     	rtune_data_type_t type;
-    } input_coefs[MAX_NUM_VARS];
+    } *input_coefs;
     int num_coefs;
 } rtune_objective_t;
 
+/**
+ * A compiled update schedule of a var or func at the begin or the end of a region. rtune_region_compile builds the entries
+ * from the update schedule attrs of vars and funcs, with the RTUNE_DEFAULT_NONE attrs of a func resolved from the var it follows.
+ * rtune_region_begin/end then only need to compare the iteration count with the next iteration of each entry to find
+ * what is due.
+ */
+typedef struct rtune_sched {
+    int next;            //the next iteration this entry is due, INT_MAX if the entry is done
+    int start;           //the first iteration of the schedule
+    int end;             //the iteration the schedule ends (exclusive), INT_MAX if it ends only when the var/func completes its update
+    int batch_size;
+    int period;          //batch_size + update_iteration_stride
+    int every_iteration; //1 if each iteration of a batch needs to be processed (e.g. accumulate), 0 if only the first iteration
+    rtune_var_update_kind_t update_lt;
+    rtune_var_update_kind_t update_policy;
+    rtune_var_t *var;    //the var of this entry, or the var whose schedule a func follows
+    rtune_func_t *func;  //the func of this entry, NULL for a var entry
+} rtune_sched_t;
+
+/**
+ * The memory arena of a region, from which all the buffers of the region are allocated, e.g. the states of vars/funcs
+ * and the compiled schedule. It is a chain of cache-line aligned blocks, and buffers are never freed individually. All the
+ * buffers are released at once when the region is finalized. The arena keeps one block of its high water mark while the
+ * region is kept to be reused, otherwise the blocks are returned to the system (see DEFAULT_NUM_FREE_REGIONS).
+ */
+typedef struct rtune_arena {
+    struct rtune_arena_block *head; //the current block, new buffers are allocated from it
+    size_t used;       //bytes allocated from all the blocks
+    size_t high_water; //the max bytes allocated since the arena is created
+} rtune_arena_t;
+
+//bits of the hot status word of a region, which is checked inline by rtune_region_begin/end in the caller
+#define RTUNE_REGION_HOT_TUNING 0x1 //vars/funcs are being updated or objectives evaluated, begin/end must be called
+#define RTUNE_REGION_HOT_APPLY  0x2 //retired objectives have configs that are applied in each iteration (RTUNE_VAR_APPLY_ON_READ)
+
 typedef struct rtune_region {
-    char * name;
+    //hot fields that are read by begin/end in each iteration, which are kept together in the first few cache lines
+    int hot_status; //0 when the region is retired or idle so begin/end need not to be called, see RTUNE_REGION_HOT_*. Keep it the first field
     rtune_status_t status;
+    int count; /* total number of execution of the region, which is not counted when the region is retired or idle */
+    unsigned long epoch; //advanced by each begin and end, a batched provider reads its source once per epoch
+
+    //compiled schedule, see rtune_region_compile
+    int sched_dirty; //set when a var/func is added, resetted or its schedule is changed so the schedule needs to be recompiled
+    int next_begin;  //the next iteration any begin entry is due
+    int next_end;    //the next iteration any end entry is due
+    rtune_sched_t *begin_sched;
+    int num_begin_sched;
+    rtune_sched_t *end_sched;
+    int num_end_sched;
+    int sched_capacity; //number of entries begin_sched, end_sched and on_read_vars are allocated for
+    struct rtune_objective **due_objs; //objectives whose funcs have new states in the current iteration, allocated for max_objs
+    int num_due_objs;
+    rtune_var_t **on_read_vars; //vars with RTUNE_VAR_APPLY_ON_READ that are being tuned
+    int num_on_read_vars;
+    rtune_func_t **topo_funcs; //the derived funcs in the topological order of the dependency DAG of vars -> funcs -> derived funcs
+    int num_topo_funcs;
+    int topo_capacity; //number of funcs topo_funcs and dirty_funcs are allocated for
+    unsigned long *dirty_funcs; //bitset indexed as topo_funcs, the derived funcs whose inputs have new states in the current iteration
+
+    //cold fields that are used when the region is set up, looked up, or when an objective is evaluated
+    char * name; //name, codeptr_ra and key_hash are the key of the region, which is not changed while a lookup can reach the region
     const void *codeptr_ra;
+    unsigned long key_hash; //hash of (name, codeptr_ra), the key of the region in the region registry
+    uint64_t rng_state; //the RNG of the random updates and designs of the region, seeded from its name, see rtune_region_set_seed
+    struct rtune_region *next_free; //link of the limbo or the free list of finalized regions, see rtune_region_reclaim
     const void *end_codeptr;
     const void *end_codeptr2;
-    int count; /* total number of execution of the region */
 
+    //vars, funcs and objectives are allocated one by one from the arena, and their arrays grow by doubling
     int num_vars; //number of variables for a tuning region
+    int max_vars;
     //rtune variables include both system/perf variable and user variables. System/perf variable are those
     //related to performance objectives, e.g. timestamp, frequency, power/energy read, and even CPU counters
     //user variables are user provided variables for tuning certain objectives
-    rtune_var_t vars[MAX_NUM_VARS];
+    rtune_var_t **vars;
 
-    rtune_func_t funcs[MAX_NUM_FUNCS];
+    rtune_func_t **funcs;
     int num_funcs;
+    int max_funcs;
 
     //model definition
-    rtune_objective_t objs[MAX_NUM_OBJ];
+    rtune_objective_t **objs;
     int num_objs;
+    int max_objs;
     int num_retired_objs;
 
     FILE * rtune_logfile;
+    struct rtune_perf_group *perf_group; //the perf_event group of the counters of the region, see rtune_perf_counter_add
+    struct rtune_rusage_source *rusage_source; //the resource usage read for the rusage counters of the region, see rtune_rusage_add
+    struct rtune_energy *energy; //the RAPL energy source of the region, see rtune_energy_add
+    rtune_arena_t arena;
 } rtune_region_t;
 
 //extern rtune_region_t * rtune_regions;
@@ -414,9 +717,23 @@ extern "C" {
  * them have the same property of variables.
  */
  
+/**
+ * Regions are kept in a global registry keyed by name and/or codeptr_ra. Lookup is lock-free and can be called from any thread,
+ * e.g. from within an OpenMP parallel region. Creating or finalizing a region is serialized internally.
+ *
+ * rtune_region_init returns the region already registered with the same name, or creates one if none. rtune_region_get
+ * does the same for the (name, codeptr_ra) key (either can be NULL, but not both) and reports via *created (if not NULL)
+ * whether the caller created the region and thus should set up its vars, funcs and objectives.
+ */
 rtune_region_t * rtune_region_init(char * name);
+rtune_region_t * rtune_region_get(char * name, const void * codeptr_ra, int * created);
+rtune_region_t * rtune_region_lookup(const char * name, const void * codeptr_ra);
+void rtune_region_fini(rtune_region_t * region);
+void rtune_region_compile(rtune_region_t * region); //compile the update schedules, called by rtune_region_begin if setup is changed
 void rtune_region_begin(rtune_region_t * region);
 void rtune_region_end(rtune_region_t * end);
+void rtune_region_rearm(rtune_region_t * region); //reset the retired objectives and their funcs and vars to tune the region again
+void rtune_region_set_seed(rtune_region_t * region, uint64_t seed); //seed the RNG of the region to reproduce or vary its random updates
 void rtune_regin_begin_sync(rtune_region_t * region); //the call will synced across multiple process, e.g. via MPI_Barrier
 void rtune_region_end_sync(rtune_region_t * end);
 
@@ -433,24 +750,57 @@ void  rtune_var_set_callback(rtune_var_t *var, void (*callback) (void *), void *
 void  rtune_var_set_applier_policy(rtune_var_t *var, void (*applier) (void *), rtune_var_apply_policy_t apply_policy); //to set the applier and policy of the var
 void  rtune_var_set_applier(rtune_var_t *var, void (*applier) (void *)); //to set the applier of the var. the applier is called when the var is updated.
 void  rtune_var_set_apply_policy(rtune_var_t * var, rtune_var_apply_policy_t apply_policy); //set the apply policy for the variables in each iteration 
+//to skip the applier for RTUNE_VAR_APPLY_ON_READ when the value in effect is the one to apply, see rtune_apply_check_t
+void  rtune_var_set_apply_check(rtune_var_t * var, void *(*reader) (void *), void * reader_arg);
+void  rtune_var_set_apply_generation(rtune_var_t * var, const volatile unsigned long * generation);
 //helper
 void rtune_var_print_list_range(rtune_var_t * var, int count);
 
 //API for creating functions/models. A function is a variable, whose value is determined by the function with specified input variables
+//The input of a derived func can be a var or a func, and a func with coefficients takes them as pointers to values of the type of the input
 void* rtune_func_add_log(rtune_region_t *region, char * name, rtune_data_type_t type, void * var);
 void* rtune_func_add_abs(rtune_region_t *region, char * name, rtune_data_type_t type, void * var);
-void* rtune_func_add_gradient(rtune_region_t *region, char * name, rtune_data_type_t type, void * var);
+void* rtune_func_add_gradient(rtune_region_t *region, char * name, rtune_data_type_t type, void * var); /* the gradient of var over the first input var of it if var is a func, otherwise over the updates of var */
 
 void* rtune_func_add_diff(rtune_region_t *region, char * name, rtune_data_type_t type, void * var1, void *var2);
 void* rtune_func_add_threshold(rtune_region_t *region, char * name, rtune_data_type_t type, void * var, void *threshold);  /* This variable is a bin variable, if var < threshold, its value is 0, otherwise, its value is 1 */
 void* rtune_func_add_distance(rtune_region_t *region, char * name, rtune_data_type_t type, void * var, void *target);  /* This variable is distance variable, whose value is var - target */
+void* rtune_func_add_ratio(rtune_region_t *region, char * name, rtune_data_type_t type, void * numerator, void *denominator); /* e.g. work per second, 0 if denominator is 0 */
+void* rtune_func_add_product(rtune_region_t *region, char * name, rtune_data_type_t type, void * var1, void *var2); /* e.g. energy x time */
 
 void* rtune_func_add(rtune_region_t * region, rtune_kind_t kind, char * name, rtune_data_type_t type, int num_vars, int num_coefficients, ...);
+//parallel efficiency work/(exe_time*num_threads), i.e. the throughput per thread, updated with each new state of exe_time.
+//work is the var of the work size of the region, or NULL if the work is fixed
+rtune_func_t* rtune_func_add_efficiency(rtune_region_t * region, char * name, rtune_func_t * exe_time, rtune_var_t * num_threads, rtune_var_t * work);
+//the parallel efficiency of a sample of an efficiency func relative to the sample with the fewest threads, 1.0 for perfect scaling
+float rtune_calcuate_scalability(rtune_func_t * efficiency, int index);
+//fit a model of the func over its first input var with each new sample of the func, see rtune_model_t
+int rtune_func_set_model(rtune_func_t * func, rtune_kind_t model_kind);
+int rtune_model_init(rtune_model_t * model, rtune_kind_t kind); //0 on success, -1 if the kind is not a supported model
+void rtune_model_set_domain(rtune_model_t * model, double lo, double hi); //the range of x, before any sample is added
+void rtune_model_clear(rtune_model_t * model); //drop the samples and the fit
+void rtune_model_add_sample(rtune_model_t * model, double x, double y);
+double rtune_model_predict(const rtune_model_t * model, double x);
+//the x in [lo, hi] where the model predicts the min (or the max) y, 0 on success, -1 if the model is not fitted yet
+int rtune_model_optimum(const rtune_model_t * model, int maximize, double lo, double hi, double * x);
 //add a function that will be modeled based on the input and function value, input are knowns, but not the function.
 rtune_func_t* rtune_func_add_model(rtune_region_t * region, rtune_kind_t kind, char * name, rtune_data_type_t type,void *(*provider) (void *), void * provider_arg, int num_vars, ...);
 void  rtune_func_set_update_schedule_attr(rtune_func_t * var, rtune_var_update_kind_t update_lt, rtune_var_update_kind_t update_policy, int update_iteration_start, int update_batch, int update_iteration_stride);
 
 //API for objectives, an objective is basically a flag to indicate whether a variable (var, func, model) meets certain criteria
+//the trace mode and streaming statistics of a var or func, which is passed as var_or_func since stvar is the first field of both
+void rtune_stvar_set_trace_mode(void * var_or_func, rtune_trace_mode_t mode);
+void rtune_stvar_set_ewma_alpha(void * var_or_func, double alpha);
+const rtune_stats_t * rtune_stvar_get_stats(void * var_or_func);
+double rtune_stats_variance(const rtune_stats_t * stats);
+double rtune_stats_stddev(const rtune_stats_t * stats);
+
+//zero-copy views of the columns of the sample store of a func, see rtune_samples_t
+rtune_column_t rtune_func_column_value(rtune_func_t * func);
+rtune_column_t rtune_func_column_iteration(rtune_func_t * func);
+rtune_column_t rtune_func_column_var(rtune_func_t * func, int var);
+rtune_column_t rtune_func_column_var_index(rtune_func_t * func, int var);
+
 rtune_objective_t * rtune_objective_add_min(rtune_region_t *region, char *name, rtune_func_t *func);
 rtune_objective_t * rtune_objective_add_max(rtune_region_t *region, char *name, rtune_func_t *func);
 rtune_objective_t * rtune_objective_add_intersection(rtune_region_t *region, char *name, rtune_func_t * func1, rtune_func_t * func2);
@@ -469,12 +819,83 @@ void rtune_objective_set_fidelity_attr(rtune_objective_t *obj, float deviation_t
 void rtune_objective_set_max_mets(rtune_objective_t *obj, int max); //set the max number of mets an objective is allowed. by default it is 1, -1 for unlimited amount of occurrence
 int  rtune_objective_is_met(rtune_objective_t *obj, int * occurence); //check whether objective is met or not */
 void rtune_objective_set_search_strategy(rtune_objective_t *obj, rtune_objective_attribute_t search_strategy);
+//the design and the number of configs (0 for the default) RTUNE_OBJECTIVE_SEARCH_RANDOM samples
+void rtune_objective_set_design(rtune_objective_t *obj, rtune_design_t design, int num_configs);
 void rtune_objective_set_metaction(rtune_objective_t *obj, rtune_action_t metaction);
 void rtune_objective_set_metaction_var(rtune_objective_t *obj, rtune_var_t *var, rtune_action_t metaction);
 void rtune_objective_set_metaction_func(rtune_objective_t *obj, rtune_func_t * func, rtune_action_t metaction);
 
 void rtune_objective_set_apply_policy(rtune_objective_t * obj,  rtune_var_apply_policy_t apply_policy); //set the apply policy for all the variables that are the input for the object func
 
+//Built-in providers for ext vars/funcs, e.g. rtune_func_add_model(region, RTUNE_FUNC_EXT_DIFF, "time", RTUNE_double, RTUNE_TIMER_NS, NULL, ...).
+//They can be used as a provider of any data type since the runtime reads them inline. They can also be called directly.
+double rtune_timer_ns(void * arg);     //monotonic raw time in nanoseconds, from the vDSO clock_gettime
+double rtune_timer_ms(void * arg);     //monotonic raw time in milliseconds
+double rtune_timer_cycles(void * arg); //TSC cycles if the TSC is invariant, otherwise nanoseconds
+double rtune_timer_cycles_per_ns(void); //the TSC frequency calibrated at init, 1.0 if the TSC is not used
+//cast via the generic void (*)(void) so -Wcast-function-type is not raised, the runtime calls them as returning double
+#define RTUNE_TIMER_NS ((void *(*)(void *)) (void (*)(void)) rtune_timer_ns)
+#define RTUNE_TIMER_MS ((void *(*)(void *)) (void (*)(void)) rtune_timer_ms)
+#define RTUNE_TIMER_CYCLES ((void *(*)(void *)) (void (*)(void)) rtune_timer_cycles)
+
+//Scan kernels over count states of a data type, which are used by the find min/max of a stvar and the unimodal checks.
+//They are dispatched to the AVX-512 or AVX2 version if the CPU supports it, otherwise to a portable loop.
+typedef enum rtune_kernel_isa {
+    RTUNE_KERNEL_SCALAR,
+    RTUNE_KERNEL_AVX2,
+    RTUNE_KERNEL_AVX512,
+} rtune_kernel_isa_t;
+rtune_kernel_isa_t rtune_kernel_get_isa(void);
+int rtune_kernel_set_isa(rtune_kernel_isa_t isa); //use a narrower ISA than the CPU supports, e.g. to compare, -1 if not supported
+int rtune_kernel_argmin(rtune_data_type_t type, const void * values, int count); //the last index of the min, -1 if count is 0
+int rtune_kernel_argmax(rtune_data_type_t type, const void * values, int count); //the last index of the max, -1 if count is 0
+//the number of consecutive pairs whose relative deviation is at least tolerance in the direction (increasing or decreasing)
+//and not within the dispersion of the pair if dispersion is provided, see rtune_objective_set_fidelity_attr
+int rtune_kernel_trend(rtune_data_type_t type, const void * values, const double * dispersion, int count, double tolerance, int increasing);
+
+//A reproducible RNG (SplitMix64) whose state is kept by the caller, and the designs of points in the unit cube of num_dims dims
+//to sample a space of several vars within a budget. A Sobol sequence covers the cube more evenly than random points, and a
+//Latin hypercube samples each of num_samples strata of each dim once.
+uint64_t rtune_rng_next(uint64_t * state);
+double rtune_rng_uniform(uint64_t * state); //in [0, 1)
+int rtune_rng_below(uint64_t * state, int n); //in [0, n)
+//num_samples rows of num_dims points in [0, 1), 0 on success, -1 if the design does not support num_dims
+int rtune_design_generate(rtune_design_t design, int num_samples, int num_dims, uint64_t * rng_state, double * points);
+
+//perf_event counters as providers of RTUNE_FUNC_EXT_DIFF funcs, e.g.
+//rtune_func_add_model(region, RTUNE_FUNC_EXT_DIFF, "instructions", RTUNE_double, RTUNE_PERF_COUNTER, rtune_perf_counter_add(region, RTUNE_PERF_INSTRUCTIONS), 1, var)
+//The counters of a region are opened as one group when they are added, and the group is read with one read() per epoch
+//of the region (see rtune_region_t::epoch), scaled for multiplexing. Counters count the calling thread, and also the threads
+//it creates afterwards if the kernel supports reading an inherited group.
+rtune_perf_counter_t * rtune_perf_counter_add(rtune_region_t * region, rtune_perf_event_t event);
+int rtune_perf_counter_event(rtune_perf_counter_t * counter); //the event being counted after fallback, -1 if the counter is not available
+double rtune_perf_counter_read(void * counter);
+#define RTUNE_PERF_COUNTER ((void *(*)(void *)) (void (*)(void)) rtune_perf_counter_read)
+
+//resource usage of the process as providers of ext vars and funcs, e.g.
+//rtune_var_add_ext(region, "max_rss", 100, RTUNE_double, RTUNE_RUSAGE, rtune_rusage_add(region, RTUNE_RUSAGE_MAX_RSS))
+//getrusage and /proc/self/stat are each read at most once per epoch of the region for all the counters of the region.
+rtune_rusage_counter_t * rtune_rusage_add(rtune_region_t * region, rtune_rusage_field_t field);
+double rtune_rusage_read(void * counter);
+#define RTUNE_RUSAGE ((void *(*)(void *)) (void (*)(void)) rtune_rusage_read)
+
+//the root of the sysfs tree that the energy provider and the cpufreq applier use, which is $RTUNE_SYSFS_ROOT if it is set
+//or /sys by default. It can be set to a fake tree, e.g. for testing, before the providers are added
+void rtune_sysfs_set_root(const char * root);
+
+//energy of the RAPL packages (powercap intel-rapl:N zones) in joules as a provider, accumulated across the wraparounds of the
+//energy_uj counters. The zones are read once per epoch of the region
+rtune_energy_t * rtune_energy_add(rtune_region_t * region); //NULL if no RAPL zone can be read
+double rtune_energy_read(void * energy);
+#define RTUNE_ENERGY ((void *(*)(void *)) (void (*)(void)) rtune_energy_read)
+
+//applier of a RTUNE_long var of CPU frequency in kHz, which sets the frequency of all the CPUs via cpufreq scaling_setspeed
+//if the governor is userspace, or caps it via scaling_max_freq otherwise. The values of the files before they are opened are
+//written back by rtune_cpufreq_fini, which also runs at exit and when the sysfs root is changed
+int  rtune_cpufreq_init(void); //open the cpufreq files of the CPUs, returns the number of CPUs whose frequency can be set
+void rtune_cpufreq_apply(void * freq_khz);
+void rtune_cpufreq_fini(void); //restore the frequencies of the CPUs and close the cpufreq files
+
 //API for callback, which is a function to be called when a var/obj/end is updated/evaluated, etc. TODO: need more scenario to show its usage
 void rtune_region_begin_add_callback(rtune_region_t * region, void *(*callback) (void *), void *arg);
 void rtune_region_end_add_callback(rtune_region_t * region, void *(*callback) (void *), void *arg);
@@ -488,9 +909,30 @@ rtune_objective_t * rtune_objective_perf_numThreads(rtune_region_t * region, sho
 rtune_objective_t * rtune_objective_energy_cpuFrequency(rtune_region_t * region, unsigned long min_freq, unsigned long max_freq, unsigned long step, int update_rate);
 //For the best edp (perf gradient * energy gradient over CPU frequency. By changing the CPU frequency, to get product of energy change and performance change
 rtune_objective_t * rtune_objective_edp_cpuFrequency(rtune_region_t * region, unsigned long min_freq, unsigned long max_freq, unsigned long step, int update_rate);
-//For weak scaling: overall performance(or per thread performance) over OpenMP num_threads and problem size
-rtune_objective_t * rtune_objective_weak_numThreads_size(rtune_region_t * region, unsigned long min_freq, unsigned long max_freq, unsigned long step, int update_rate);
+//For weak scaling: per thread performance over OpenMP num_threads. The problem size is not tuned, it is read from the
+//problem_size of the application in each iteration
+rtune_objective_t * rtune_objective_weak_numThreads_size(rtune_region_t * region, short min_num_threads, short max_num_threads, short step, long * problem_size, int update_rate);
+//opt-in callback of the weak scaling objective to print the parallel efficiency of the num_threads found, see rtune_calcuate_scalability
+void rtune_objective_print_scalability(rtune_objective_t * obj, void * arg);
+
 
+/**
+ * Inline fast path of rtune_region_begin/end: a region that is retired or idle costs only a check of its hot status word in
+ * the caller. The calls go to the library only when the region is tuning or has configs to apply in each iteration.
+ * Define RTUNE_NO_INLINE_FASTPATH before including this header to always call the library.
+ */
+static inline void rtune_region_begin_inline(rtune_region_t * region) {
+    if (__builtin_expect(region->hot_status != 0, 0)) rtune_region_begin(region);
+}
+
+static inline void rtune_region_end_inline(rtune_region_t * region) {
+    if (__builtin_expect((region->hot_status & RTUNE_REGION_HOT_TUNING) != 0, 0)) rtune_region_end(region);
+}
+
+#ifndef RTUNE_NO_INLINE_FASTPATH
+#define rtune_region_begin(region) rtune_region_begin_inline(region)
+#define rtune_region_end(region) rtune_region_end_inline(region)
+#endif
 
 #ifdef  __cplusplus
 };
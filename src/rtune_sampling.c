@@ -0,0 +1,108 @@
+#include <string.h>
+
+#include "rtune_runtime.h"
+
+/**
+ * The RNG of the runtime is SplitMix64, whose state is a single 64-bit word that is kept by the user of the RNG, e.g. each
+ * region has one (see rtune_region_set_seed), so the random updates of a region are reproducible with its seed and do not
+ * share the global state of random() with the application or other threads.
+ */
+uint64_t rtune_rng_next(uint64_t * state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+double rtune_rng_uniform(uint64_t * state) {
+    return (double) (rtune_rng_next(state) >> 11) * 0x1.0p-53;
+}
+
+int rtune_rng_below(uint64_t * state, int n) {
+    return n > 0 ? (int) (rtune_rng_uniform(state) * n) : 0;
+}
+
+/**
+ * The primitive polynomials and the initial direction numbers m of the Sobol sequence for dimensions 2 to
+ * RTUNE_DESIGN_MAX_DIMS, from the table of Joe and Kuo. The first dimension is the van der Corput sequence in base 2.
+ */
+static const struct {
+    int degree;
+    unsigned int coefficients;
+    unsigned int m[RTUNE_DESIGN_MAX_DIMS];
+} rtune_sobol_params[RTUNE_DESIGN_MAX_DIMS - 1] = {
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}},
+};
+
+#define RTUNE_SOBOL_BITS 32
+
+/**
+ * the direction numbers v of a dimension of the Sobol sequence, scaled to RTUNE_SOBOL_BITS bits
+ */
+static void rtune_sobol_directions(int dim, unsigned int *v) {
+    int k, i;
+    if (dim == 0) {
+        for (k = 0; k < RTUNE_SOBOL_BITS; k++) v[k] = 1u << (RTUNE_SOBOL_BITS - 1 - k);
+        return;
+    }
+    int s = rtune_sobol_params[dim - 1].degree;
+    unsigned int a = rtune_sobol_params[dim - 1].coefficients;
+    for (k = 0; k < s && k < RTUNE_SOBOL_BITS; k++) v[k] = rtune_sobol_params[dim - 1].m[k] << (RTUNE_SOBOL_BITS - 1 - k);
+    for (k = s; k < RTUNE_SOBOL_BITS; k++) {
+        v[k] = v[k - s] ^ (v[k - s] >> s);
+        for (i = 1; i < s; i++) {
+            if ((a >> (s - 1 - i)) & 1) v[k] ^= v[k - i];
+        }
+    }
+}
+
+/**
+ * Generate num_samples points of a design in the unit cube of num_dims dims, row by row in points. A Latin hypercube
+ * splits each dim into num_samples strata and samples each stratum once at a random position, with the strata of the
+ * dims matched by a random permutation (Fisher-Yates) for each dim. The Sobol points are from the second point of the
+ * sequence with the Gray code order since the first one is the corner at 0.
+ * @return 0 on success, -1 if the design does not support num_dims
+ */
+int rtune_design_generate(rtune_design_t design, int num_samples, int num_dims, uint64_t * rng_state, double * points) {
+    int i, j;
+    if (num_dims <= 0) return -1;
+    switch (design) {
+        case RTUNE_DESIGN_RANDOM:
+            for (i = 0; i < num_samples * num_dims; i++) points[i] = rtune_rng_uniform(rng_state);
+            return 0;
+        case RTUNE_DESIGN_LATIN_HYPERCUBE:
+            for (j = 0; j < num_dims; j++) {
+                for (i = 0; i < num_samples; i++) points[i * num_dims + j] = (i + rtune_rng_uniform(rng_state)) / num_samples;
+                for (i = num_samples - 1; i > 0; i--) {
+                    int k = rtune_rng_below(rng_state, i + 1);
+                    double t = points[i * num_dims + j];
+                    points[i * num_dims + j] = points[k * num_dims + j];
+                    points[k * num_dims + j] = t;
+                }
+            }
+            return 0;
+        case RTUNE_DESIGN_SOBOL: {
+            if (num_dims > RTUNE_DESIGN_MAX_DIMS) return -1;
+            unsigned int v[RTUNE_DESIGN_MAX_DIMS][RTUNE_SOBOL_BITS];
+            unsigned int x[RTUNE_DESIGN_MAX_DIMS];
+            memset(x, 0, sizeof(x));
+            for (j = 0; j < num_dims; j++) rtune_sobol_directions(j, v[j]);
+            for (i = 0; i < num_samples; i++) {
+                int c = __builtin_ctz(~(unsigned int) i); //the lowest zero bit of i, the point i+1 is the point i with it flipped
+                for (j = 0; j < num_dims; j++) {
+                    x[j] ^= v[j][c];
+                    points[i * num_dims + j] = (double) x[j] / 4294967296.0;
+                }
+            }
+            return 0;
+        }
+        default:
+            return -1;
+    }
+}